@@ -0,0 +1,40 @@
+/*
+ * Activations.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+extern "C" {
+#include "network.h"
+}
+
+namespace darknet_ros {
+
+//! Applies an activation in place to n values.
+typedef void (*ActivationKernel)(float *x, int n);
+
+//! Computes x = activation(x * scale + shift) in place for n values.
+typedef void (*AffineActivationKernel)(float *x, int n, float scale, float shift);
+
+/*!
+ * SIMD implementation of a darknet activation. Every activation type is vectorized except
+ * STAIR, which falls back to darknet's scalar code.
+ */
+ActivationKernel activationKernel(ACTIVATION a);
+
+/*!
+ * Same as activationKernel() with an affine transform applied first, so batch norm, bias and
+ * activation of a channel take a single pass over its output.
+ */
+AffineActivationKernel affineActivationKernel(ACTIVATION a);
+
+/*!
+ * Replaces the forward of shortcut and yolo layers with versions that use the vectorized
+ * activations. Convolutional layers get theirs through their ConvolutionKernel.
+ * @return number of replaced layers.
+ */
+int installVectorizedActivations(network *net);
+
+} /* namespace darknet_ros*/
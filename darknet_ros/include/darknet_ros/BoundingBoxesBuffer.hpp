@@ -0,0 +1,130 @@
+/*
+ * BoundingBoxesBuffer.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+// c++
+#include <algorithm>
+#include <vector>
+
+// ROS
+#include <ros/message_traits.h>
+#include <ros/serialization.h>
+#include <std_msgs/Header.h>
+
+// darknet_ros_msgs
+#include <darknet_ros_msgs/BoundingBoxes.h>
+
+namespace darknet_ros {
+
+/*!
+ * Bounding boxes of one frame whose storage persists across frames. It is published in place
+ * of darknet_ros_msgs::BoundingBoxes with the same wire format, but only the first count()
+ * boxes are serialized: boxes past the count keep their class name strings, so refilling the
+ * buffer does not allocate once it has seen the largest frame.
+ */
+class BoundingBoxesBuffer
+{
+ public:
+  std_msgs::Header header;
+  std_msgs::Header image_header;
+
+  /*!
+   * Makes room for boxes with class names of up to labelLength characters.
+   */
+  void reserve(size_t boxes, size_t labelLength)
+  {
+    if (boxes > boxes_.size()) boxes_.resize(boxes);
+    for (darknet_ros_msgs::BoundingBox& box : boxes_) {
+      box.Class.reserve(labelLength);
+    }
+  }
+
+  void clear() { count_ = 0; }
+
+  /*!
+   * Appends a box, its fields hold stale values of an earlier frame.
+   */
+  darknet_ros_msgs::BoundingBox& add()
+  {
+    if (count_ == boxes_.size()) boxes_.resize(std::max<size_t>(1, 2 * boxes_.size()));
+    return boxes_[count_++];
+  }
+
+  size_t count() const { return count_; }
+  const darknet_ros_msgs::BoundingBox& operator[](size_t i) const { return boxes_[i]; }
+
+  /*!
+   * Copies the boxes into a message, e.g. for action results.
+   */
+  void copyTo(darknet_ros_msgs::BoundingBoxes *message) const
+  {
+    message->header = header;
+    message->image_header = image_header;
+    message->bounding_boxes.assign(boxes_.begin(), boxes_.begin() + count_);
+  }
+
+ private:
+  std::vector<darknet_ros_msgs::BoundingBox> boxes_;
+  size_t count_ = 0;
+};
+
+} /* namespace darknet_ros*/
+
+namespace ros {
+namespace message_traits {
+
+template<>
+struct MD5Sum<darknet_ros::BoundingBoxesBuffer>
+{
+  static const char *value() { return MD5Sum<darknet_ros_msgs::BoundingBoxes>::value(); }
+  static const char *value(const darknet_ros::BoundingBoxesBuffer&) { return value(); }
+};
+
+template<>
+struct DataType<darknet_ros::BoundingBoxesBuffer>
+{
+  static const char *value() { return DataType<darknet_ros_msgs::BoundingBoxes>::value(); }
+  static const char *value(const darknet_ros::BoundingBoxesBuffer&) { return value(); }
+};
+
+template<>
+struct Definition<darknet_ros::BoundingBoxesBuffer>
+{
+  static const char *value() { return Definition<darknet_ros_msgs::BoundingBoxes>::value(); }
+  static const char *value(const darknet_ros::BoundingBoxesBuffer&) { return value(); }
+};
+
+} /* namespace message_traits */
+
+namespace serialization {
+
+template<>
+struct Serializer<darknet_ros::BoundingBoxesBuffer>
+{
+  template<typename Stream>
+  inline static void write(Stream& stream, const darknet_ros::BoundingBoxesBuffer& buffer)
+  {
+    stream.next(buffer.header);
+    stream.next(buffer.image_header);
+    stream.next((uint32_t) buffer.count());
+    for (size_t i = 0; i < buffer.count(); ++i) {
+      stream.next(buffer[i]);
+    }
+  }
+
+  inline static uint32_t serializedLength(const darknet_ros::BoundingBoxesBuffer& buffer)
+  {
+    uint32_t size = serializationLength(buffer.header) + serializationLength(buffer.image_header) + 4;
+    for (size_t i = 0; i < buffer.count(); ++i) {
+      size += serializationLength(buffer[i]);
+    }
+    return size;
+  }
+};
+
+} /* namespace serialization */
+} /* namespace ros */
@@ -0,0 +1,71 @@
+/*
+ * BoxTracker.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+// c++
+#include <vector>
+
+extern "C" {
+#include "box.h"
+}
+
+namespace darknet_ros {
+
+//! One detected box of one class, coordinates relative to the frame.
+struct TrackedBox
+{
+  box bbox;
+  int classId;
+  float prob;
+};
+
+/*!
+ * Temporal smoothing of decoded detections. Boxes of consecutive frames are associated by
+ * class and overlap, and position, size and score of every track follow an exponential
+ * moving average. A track that is missed keeps being reported with a decaying score for a
+ * few frames, so single missed detections do not flicker. Cost and memory grow with the
+ * number of objects, not with the size of the network output.
+ */
+class BoxTracker
+{
+ public:
+  struct Options
+  {
+    //! Weight of the new frame in the moving average, 1 disables smoothing.
+    float alpha = .5f;
+    //! Minimum overlap (IoU) of a box with a track to continue it.
+    float minOverlap = .3f;
+    //! Frames a track survives without a matching box.
+    int maxMisses = 2;
+  };
+
+  explicit BoxTracker(const Options& options);
+
+  /*!
+   * Associates the boxes of a new frame with the tracks and replaces them with the smoothed
+   * tracks.
+   * @param[in] thresh score below which missed tracks are no longer reported.
+   */
+  void update(std::vector<TrackedBox> *boxes, float thresh);
+
+  /*!
+   * Drops all tracks.
+   */
+  void clear() { tracks_.clear(); }
+
+ private:
+  struct Track
+  {
+    TrackedBox box;
+    int misses;
+  };
+
+  Options options_;
+  std::vector<Track> tracks_;
+};
+
+} /* namespace darknet_ros*/
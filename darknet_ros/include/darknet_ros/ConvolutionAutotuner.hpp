@@ -0,0 +1,75 @@
+/*
+ * ConvolutionAutotuner.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+// c++
+#include <map>
+#include <string>
+#include <vector>
+
+// darknet_ros
+#include "darknet_ros/ConvolutionKernels.hpp"
+
+namespace darknet_ros {
+
+/*!
+ * Benchmarks the candidate convolution plans for every distinct layer shape of a network and
+ * installs the fastest one. Results are persisted in a cache file keyed by CPU model and
+ * network hash, so a machine only pays the tuning cost once per network.
+ */
+class ConvolutionAutotuner
+{
+ public:
+  /*!
+   * Constructor.
+   * @param[in] cacheFile path of the tuning cache, created if missing.
+   * @param[in] iterations timed runs per candidate; the fastest run counts.
+   */
+  ConvolutionAutotuner(const std::string& cacheFile, int iterations);
+
+  /*!
+   * Selects and installs a plan for every convolutional layer of the network.
+   * @return number of layer shapes that had to be benchmarked.
+   */
+  int tune(network *net);
+
+  /*!
+   * Model name of the CPU this process runs on.
+   */
+  static std::string cpuModel();
+
+  /*!
+   * Hash over the input size and the shape of every layer.
+   */
+  static std::string networkHash(const network *net);
+
+  /*!
+   * Key identifying a convolutional layer shape.
+   */
+  static std::string shapeKey(const layer& l);
+
+ private:
+  bool loadCache(const std::string& cpu, const std::string& hash);
+
+  bool saveCache(const std::string& cpu, const std::string& hash) const;
+
+  ConvolutionPlan benchmark(network *net, int index) const;
+
+  //! Path of the cache file.
+  std::string cacheFile_;
+
+  //! Timed runs per candidate.
+  int iterations_;
+
+  //! Winning plans of this CPU and network, by shape key.
+  std::map<std::string, ConvolutionPlan> plans_;
+
+  //! Cache lines of other CPUs or networks, written back untouched.
+  std::vector<std::string> foreignEntries_;
+};
+
+} /* namespace darknet_ros*/
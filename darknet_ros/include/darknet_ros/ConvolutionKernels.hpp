@@ -0,0 +1,121 @@
+/*
+ * ConvolutionKernels.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+// c++
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// darknet_ros
+#include "darknet_ros/Activations.hpp"
+
+extern "C" {
+#include "network.h"
+}
+
+namespace darknet_ros {
+
+//! CPU strategies a convolutional layer can be dispatched to.
+enum class ConvolutionAlgorithm
+{
+  Im2colGemm,   // unrolled input times weights, one L2-sized tile of output rows at a time
+  Pointwise,    // 1x1/stride 1 layers as a plain GEMM on the input
+  Direct,       // sliding window without any unrolled workspace
+  Winograd,     // F(2x2, 3x3) for 3x3/stride 1 layers
+  Xnor          // bit-packed signs and popcount for xnor layers
+};
+
+//! Algorithm and tile size chosen for one layer, 0 for the algorithm's default tile.
+struct ConvolutionPlan
+{
+  ConvolutionAlgorithm algorithm = ConvolutionAlgorithm::Im2colGemm;
+  int tile = 0;
+};
+
+/*!
+ * Name of an algorithm as written to the tuning cache.
+ */
+std::string algorithmName(ConvolutionAlgorithm algorithm);
+
+/*!
+ * Parses an algorithm name written by algorithmName().
+ * @return false if the name is unknown.
+ */
+bool parseAlgorithmName(const std::string& name, ConvolutionAlgorithm* algorithm);
+
+/*!
+ * Checks whether an algorithm can compute the given layer.
+ */
+bool isApplicable(ConvolutionAlgorithm algorithm, const layer& l);
+
+/*!
+ * Lists every applicable algorithm/tile combination for a layer, darknet's default first.
+ */
+std::vector<ConvolutionPlan> candidatePlans(const layer& l);
+
+/*!
+ * Prepared convolution of one layer (pre-transformed weights and scratch buffers).
+ */
+class ConvolutionKernel
+{
+ public:
+  ConvolutionKernel(const layer& l, const ConvolutionPlan& plan);
+
+  /*!
+   * Computes l.output from net.input. Batch norm, bias and activation are fused into one
+   * vectorized pass per output channel, chosen for the layer's activation at construction.
+   */
+  void forward(const layer& l, const network& net);
+
+  const ConvolutionPlan& plan() const { return plan_; }
+
+ private:
+  void forwardIm2colGemm(const layer& l, const network& net);
+  void forwardPointwise(const layer& l, const network& net);
+  void forwardDirect(const layer& l, const network& net);
+  void forwardWinograd(const layer& l, const network& net);
+  void forwardXnor(const layer& l, const network& net);
+
+  ConvolutionPlan plan_;
+  AffineActivationKernel activation_;
+  std::vector<float> outputScale_;
+  std::vector<float> outputShift_;
+  std::vector<float> winogradWeights_;
+  std::vector<float> scratch_;
+  //! Sign bits of every filter, signWords_ 64-bit words per filter.
+  std::vector<uint64_t> signWeights_;
+  int signWords_ = 0;
+};
+
+/*!
+ * Routes a convolutional layer of the network through a prepared kernel by replacing its
+ * forward function.
+ */
+void installConvolutionKernel(network *net, int index, const ConvolutionPlan& plan);
+
+/*!
+ * Installs a kernel on every convolutional layer that still runs darknet's forward, Xnor for
+ * xnor layers and Im2colGemm for the others.
+ * @return number of installed kernels.
+ */
+int installDefaultConvolutionKernels(network *net);
+
+/*!
+ * Reallocates net->workspace for the layers that still use it; installed kernels keep
+ * their unrolled input in small per-thread buffers instead.
+ * @return bytes released.
+ */
+size_t shrinkWorkspace(network *net);
+
+/*!
+ * Drops all kernels installed for the network.
+ */
+void clearConvolutionKernels(network *net);
+
+} /* namespace darknet_ros*/
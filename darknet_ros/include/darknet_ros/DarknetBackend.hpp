@@ -0,0 +1,67 @@
+/*
+ * DarknetBackend.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+// c++
+#include <string>
+#include <vector>
+
+// darknet_ros
+#include "darknet_ros/InferenceBackend.hpp"
+
+namespace darknet_ros {
+
+/*!
+ * Runs the model with darknet itself, after the load-time network rewrites and the CPU
+ * kernels of darknet_ros. The default backend.
+ */
+class DarknetBackend : public InferenceBackend
+{
+ public:
+  //! Load-time network rewrites.
+  struct Options
+  {
+    //! Detection heads to keep, counted in cfg order, all if empty.
+    std::vector<int> detectionHeads;
+    //! Network input size, the cfg's if 0. Multiples of 32 for yolo networks.
+    int inputWidth = 0;
+    int inputHeight = 0;
+    bool pruneZeroChannels = false;
+    bool fuseRoutes = false;
+    bool vectorizedActivations = true;
+    bool autotune = false;
+    int tuningIterations = 3;
+    std::string tuningCacheFile;
+  };
+
+  explicit DarknetBackend(const Options& options);
+
+  std::string name() const override { return "darknet"; }
+
+  /*!
+   * Loads the cfg and darknet weights and applies the rewrites of the options.
+   */
+  bool load(const std::string& config, const std::string& model) override;
+
+  int inputWidth() const override { return net_->w; }
+  int inputHeight() const override { return net_->h; }
+  int inputChannels() const override { return net_->c; }
+
+  void run(float *input) override;
+
+  const std::vector<DetectionHead>& heads() const override { return heads_; }
+
+  detection *detections(const std::vector<int>& heads, int width, int height, float thresh, float hier,
+                        int *count) override;
+
+ private:
+  Options options_;
+  network *net_ = nullptr;
+  std::vector<DetectionHead> heads_;
+};
+
+} /* namespace darknet_ros*/
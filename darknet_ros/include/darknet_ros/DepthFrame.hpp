@@ -0,0 +1,50 @@
+/*
+ * DepthFrame.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+// c++
+#include <string>
+
+// boost
+#include <boost/shared_ptr.hpp>
+
+namespace darknet_ros {
+
+/*!
+ * Depth map in its native encoding, 16UC1 in millimetres or 32FC1 in metres. The data stays
+ * owned by the message it came from, which owner keeps alive; values are only converted
+ * where they are read.
+ */
+struct DepthFrame
+{
+  enum Encoding
+  {
+    Millimetres16U,
+    Metres32F
+  };
+
+  /*!
+   * Maps a sensor_msgs/image_encodings string to a depth encoding.
+   * @return false if the encoding is not supported.
+   */
+  static bool parseEncoding(const std::string& encoding, Encoding* result);
+
+  /*!
+   * Depth at a pixel in metres, NaN if the map is empty or the pixel carries no measurement.
+   */
+  float metres(int x, int y) const;
+
+  boost::shared_ptr<const void> owner;
+  const unsigned char *data = nullptr;
+  int width = 0;
+  int height = 0;
+  int step = 0;
+  Encoding encoding = Metres32F;
+  bool bigEndian = false;
+};
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,52 @@
+/*
+ * DetectionBoxes.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+// c++
+#include <vector>
+
+// darknet_ros
+#include "darknet_ros/InferenceBackend.hpp"
+
+namespace darknet_ros {
+
+//! Overlap of the non-maximum suppression of the node.
+const float DetectionNmsOverlap = .4f;
+
+//! Width and height a box must exceed, relative to the frame (1%).
+const float MinimumBoxSize = .01f;
+
+//! Box of one class found in a frame, coordinates relative to the frame.
+struct FrameBox
+{
+  int classId;
+  float probability;
+  float xmin;
+  float ymin;
+  float xmax;
+  float ymax;
+};
+
+/*!
+ * Heads the main topics decode: the heads no head set took that have the classes of the first
+ * of them.
+ * @param[in] taken heads of head sets, indexed like heads.
+ */
+std::vector<int> mainDetectionHeads(const std::vector<DetectionHead>& heads, const std::vector<bool>& taken);
+
+/*!
+ * Non-maximum suppression of decoded detections (darknet's do_nms_obj), none if overlap <= 0.
+ */
+void suppressDetections(detection *dets, int count, int classes, float overlap = DetectionNmsOverlap);
+
+/*!
+ * Boxes of decoded detections as the node publishes them: clipped to the frame, one per class
+ * with a score, boxes not larger than MinimumBoxSize in width or height dropped.
+ */
+void collectFrameBoxes(const detection *dets, int count, int classes, std::vector<FrameBox> *boxes);
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,71 @@
+/*
+ * DetectionEvaluation.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+// c++
+#include <string>
+#include <vector>
+
+namespace darknet_ros {
+
+//! Labelled or detected object of an image set, coordinates relative to the image size.
+struct EvaluatedBox
+{
+  int image;
+  int classId;
+  float probability;
+  float xmin;
+  float ymin;
+  float xmax;
+  float ymax;
+};
+
+//! Accuracy of the detections of an image set at one threshold.
+struct DetectionEvaluation
+{
+  //! Mean of the AP of the classes with labels.
+  double map = 0;
+  double precision = 0;
+  double recall = 0;
+  std::vector<double> classAp;
+  std::vector<double> classRecall;
+};
+
+//! Cost and accuracy of one configuration.
+struct OperatingPoint
+{
+  double latency;
+  double memory;
+  double map;
+  bool pareto;
+};
+
+/*!
+ * Reads the darknet label file of an image: one "class x y width height" line per object,
+ * center and size relative to the image. An image without a label file has no objects.
+ * @param[in] directory directory of the label files, the image's if empty.
+ * @param[in] index index of the image in the set.
+ */
+void readDarknetLabels(const std::string& image, const std::string& directory, int index,
+                       std::vector<EvaluatedBox> *labels);
+
+/*!
+ * Average precision and recall of every class at a threshold, detections matched greedily
+ * by score to the best overlapping unmatched label (VOC style, all-point interpolation).
+ * @param[in] images number of images of the set.
+ * @param[in] iou overlap a detection needs to match a label.
+ */
+DetectionEvaluation evaluateDetections(const std::vector<EvaluatedBox>& labels,
+                                       const std::vector<EvaluatedBox>& detections, int images, int classes,
+                                       float threshold, float iou);
+
+/*!
+ * Marks the points no other point beats in latency, memory and mAP at once.
+ */
+void markPareto(std::vector<OperatingPoint> *points);
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,57 @@
+/*
+ * DetectionViewer.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+// c++
+#include <functional>
+#include <memory>
+#include <string>
+
+// OpenCV
+#include <opencv2/core/core.hpp>
+
+namespace darknet_ros {
+
+/*!
+ * Window showing the annotated frames. All display and window code of the node is behind this
+ * interface; headless builds (DARKNET_ROS_HEADLESS) have no implementation of it.
+ */
+class DetectionViewer
+{
+ public:
+  struct Options
+  {
+    std::string window = "YOLO V3";
+    //! Frames per second shown at most.
+    double rate = 30;
+    //! Time the GUI event loop runs per frame, in ms.
+    int waitKeyDelay = 1;
+    bool fullScreen = false;
+  };
+
+  virtual ~DetectionViewer() {}
+
+  /*!
+   * Offers an annotated frame (8 bit BGR), never waits for the GUI.
+   */
+  virtual void show(const cv::Mat& frame) = 0;
+
+  /*!
+   * @return false in headless builds or if no X server can be reached.
+   */
+  static bool displayAvailable();
+
+  /*!
+   * Opens the window.
+   * @param[in] onKey called for every key pressed in the window, on the window's thread.
+   * @return nullptr in headless builds.
+   */
+  static std::unique_ptr<DetectionViewer> create(const Options& options,
+                                                 const std::function<void(int key)>& onKey);
+};
+
+} /* namespace darknet_ros*/
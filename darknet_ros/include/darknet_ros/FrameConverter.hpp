@@ -0,0 +1,74 @@
+/*
+ * FrameConverter.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+// c++
+#include <string>
+
+// boost
+#include <boost/shared_ptr.hpp>
+
+extern "C" {
+#include "image.h"
+}
+
+namespace darknet_ros {
+
+//! Pixel layouts a camera frame can be converted from.
+enum class PixelFormat
+{
+  BGR8,
+  RGB8,
+  BGRA8,
+  RGBA8,
+  MONO8,
+  MONO16,
+  UYVY,         // sensor_msgs "yuv422"
+  YUYV,         // sensor_msgs "yuv422_yuy2"
+  NV12,
+  NV21,
+  BayerRGGB8,
+  BayerBGGR8,
+  BayerGBRG8,
+  BayerGRBG8
+};
+
+/*!
+ * Maps a sensor_msgs/image_encodings string to a pixel format.
+ * @return false if the encoding is not supported.
+ */
+bool parsePixelFormat(const std::string& encoding, PixelFormat* format);
+
+/*!
+ * Camera frame in its native encoding. The data stays owned by the message (or matrix) it
+ * came from, which owner keeps alive.
+ */
+struct CameraFrame
+{
+  boost::shared_ptr<const void> owner;
+  const unsigned char *data = nullptr;
+  int width = 0;
+  int height = 0;
+  int step = 0;
+  PixelFormat format = PixelFormat::BGR8;
+  bool bigEndian = false;
+};
+
+/*!
+ * Converts a frame to planar RGB in [0, 1] and resizes it to width x height at (dx, dy) of out,
+ * in one pass over the source. Resampling matches darknet's resize_image, and only the source
+ * pixels the bilinear filter reads are ever converted.
+ */
+void convertFrame(const CameraFrame& frame, image out, int width, int height, int dx, int dy);
+
+/*!
+ * Same as letterbox_image_into(image of frame, boxed.w, boxed.h, boxed), but straight from the
+ * native encoding. The border is set to 0.5 as in letterbox_image.
+ */
+void letterboxFrame(const CameraFrame& frame, image boxed);
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,126 @@
+/*
+ * FrameScheduler.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+// c++
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// ROS
+#include <std_msgs/Header.h>
+
+// darknet_ros
+#include "darknet_ros/DepthFrame.hpp"
+#include "darknet_ros/FrameConverter.hpp"
+
+namespace darknet_ros {
+
+//! Classes of service sharing the network, highest priority first.
+enum class FrameClass
+{
+  Live,   // camera stream
+  Goal,   // check for objects action goals
+  Batch   // goals of the offline batch action
+};
+
+//! Frame waiting for the network.
+struct ScheduledFrame
+{
+  CameraFrame image;
+  DepthFrame depth;
+  std_msgs::Header header;
+  FrameClass frameClass = FrameClass::Live;
+
+  //! Size of the original image, boxes are reported in its pixels.
+  int fullWidth = 0;
+  int fullHeight = 0;
+
+  //! Goal the frame answers, action classes only.
+  unsigned long ticket = 0;
+  int actionId = 0;
+
+  //! Set when the frame is queued.
+  std::chrono::steady_clock::time_point queued;
+};
+
+/*!
+ * Decides which frame the network runs next. Every class has its own bounded queue, and at
+ * each frame boundary the highest class with a frame waiting wins, so batch work yields to
+ * the live stream between two frames. A class can be limited to a maximum rate; its frames
+ * then wait while lower classes use the network.
+ */
+class FrameScheduler
+{
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Policy
+  {
+    //! Frames that may wait.
+    size_t capacity = 1;
+    //! Frames per second, 0 for no limit.
+    double maxRate = 0;
+    //! A full queue drops its oldest frame instead of refusing the new one.
+    bool dropOldest = false;
+  };
+
+  //! Queueing statistics of one class.
+  struct Statistics
+  {
+    unsigned long dispatched = 0;
+    unsigned long dropped = 0;
+    double meanDelay = 0;   // seconds
+    double maxDelay = 0;    // seconds
+  };
+
+  /*!
+   * Sets the queue and rate limit of a class.
+   */
+  void setPolicy(FrameClass frameClass, const Policy& policy);
+
+  /*!
+   * Queues a frame in the queue of its class.
+   * @return false if the queue was full and refused it.
+   */
+  bool push(const ScheduledFrame& frame);
+
+  /*!
+   * Takes the next frame to run, waiting at most timeout for one to become eligible.
+   * @return false on timeout.
+   */
+  bool pop(ScheduledFrame *frame, std::chrono::milliseconds timeout);
+
+  /*!
+   * Discards the waiting frames of a class.
+   * @return number of frames discarded.
+   */
+  size_t clear(FrameClass frameClass);
+
+  /*!
+   * Statistics of a class since the last call.
+   */
+  Statistics collectStatistics(FrameClass frameClass);
+
+ private:
+  struct Queue
+  {
+    Policy policy;
+    std::deque<ScheduledFrame> frames;
+    Clock::time_point nextDispatch;
+    Statistics statistics;
+  };
+
+  Queue &queue(FrameClass frameClass) { return queues_[static_cast<int>(frameClass)]; }
+
+  Queue queues_[3];
+  std::mutex mutex_;
+  std::condition_variable condition_;
+};
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,57 @@
+/*
+ * HighGuiViewer.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+// c++
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+// darknet_ros
+#include "darknet_ros/DetectionViewer.hpp"
+
+namespace darknet_ros {
+
+/*!
+ * OpenCV window showing the annotated frames. The window and its event loop live on their own
+ * low priority thread, which takes the newest frame at its own rate: the pipeline only copies
+ * a frame when the window is ready for one and never waits for the GUI.
+ */
+class HighGuiViewer : public DetectionViewer
+{
+ public:
+  /*!
+   * Opens the window and starts the thread.
+   * @param[in] onKey called on the viewer thread for every key pressed in the window.
+   */
+  HighGuiViewer(const Options& options, const std::function<void(int key)>& onKey);
+
+  /*!
+   * Stops the thread and closes the window.
+   */
+  ~HighGuiViewer();
+
+  /*!
+   * Copies the frame only if the window waits for one.
+   */
+  void show(const cv::Mat& frame) override;
+
+ private:
+  void run();
+
+  Options options_;
+  std::function<void(int key)> onKey_;
+
+  std::mutex mutex_;
+  cv::Mat pending_;
+  bool fresh_ = false;
+  std::atomic<bool> waiting_{true};
+  std::atomic<bool> running_{true};
+  std::thread thread_;
+};
+
+} /* namespace darknet_ros*/
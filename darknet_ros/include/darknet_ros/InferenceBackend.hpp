@@ -0,0 +1,96 @@
+/*
+ * InferenceBackend.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+// c++
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "network.h"
+}
+
+namespace darknet_ros {
+
+//! Raw output of one detection head, in the layout of darknet's yolo, region or detection layer.
+struct DetectionHead
+{
+  //! Output of the head, may be overwritten before decoding (e.g. averaged over frames).
+  float *output;
+  int size;
+  //! Candidate boxes the head can produce.
+  int boxes;
+  int classes;
+  //! Grid of the head and anchors per cell.
+  int width;
+  int height;
+  int anchors;
+};
+
+/*!
+ * Engine that runs the detection model. The detector only sees the input tensor, the raw
+ * head outputs and the decoded detections, so engines can be swapped without touching it.
+ */
+class InferenceBackend
+{
+ public:
+  virtual ~InferenceBackend() {}
+
+  /*!
+   * Name of the backend as used in the inference/backend parameter.
+   */
+  virtual std::string name() const = 0;
+
+  /*!
+   * Loads the model.
+   * @param[in] config darknet cfg of the model, describes input size and detection heads.
+   * @param[in] model file holding the trained model in the backend's own format.
+   * @return false if the model could not be loaded.
+   */
+  virtual bool load(const std::string& config, const std::string& model) = 0;
+
+  /*!
+   * Size of the input tensor: planar RGB in [0, 1], channels x height x width, laid out as
+   * the letterboxed darknet image of a frame.
+   */
+  virtual int inputWidth() const = 0;
+  virtual int inputHeight() const = 0;
+  virtual int inputChannels() const = 0;
+
+  /*!
+   * Runs the model on one input tensor, filling the outputs of the heads.
+   */
+  virtual void run(float *input) = 0;
+
+  /*!
+   * Detection heads of the model in cfg order, valid after load().
+   */
+  virtual const std::vector<DetectionHead>& heads() const = 0;
+
+  /*!
+   * Decodes the current outputs of some heads into detections relative to a frame of the
+   * given size. The heads have to agree on their classes.
+   * @param[in] heads indices into heads().
+   * @return detections to be freed with free_detections().
+   */
+  virtual detection *detections(const std::vector<int>& heads, int width, int height, float thresh, float hier,
+                                int *count) = 0;
+};
+
+/*!
+ * Detection heads of a darknet network, for backends that decode with darknet's layers.
+ */
+std::vector<DetectionHead> detectionHeads(network *net);
+
+/*!
+ * get_network_boxes for some of the detection heads of a darknet network.
+ * @param[in] heads indices of the heads, counted in layer order.
+ */
+detection *headDetections(network *net, const std::vector<int>& heads, int width, int height, float thresh,
+                          float hier, int *count);
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,46 @@
+/*
+ * JpegDecoder.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+// c++
+#include <cstddef>
+
+// OpenCv
+#include <opencv2/core/core.hpp>
+
+namespace darknet_ros {
+
+/*!
+ * JPEG decoder that lets libjpeg(-turbo) scale in the DCT domain, so frames are decoded
+ * straight to about the network resolution instead of to full size.
+ */
+class JpegDecoder
+{
+ public:
+  /*!
+   * Checks for the JPEG start-of-image marker.
+   */
+  static bool isJpeg(const unsigned char *data, size_t size);
+
+  /*!
+   * Largest of 1, 2, 4 and 8 by which a width x height image can be reduced while the
+   * letterboxed network input still is a downscale of it.
+   */
+  static int scaleDenominator(int width, int height, int targetWidth, int targetHeight);
+
+  /*!
+   * Decodes a JPEG to BGR8.
+   * @param[in] targetWidth, targetHeight network input size the image is letterboxed to.
+   * @param[out] bgr decoded (reduced) image.
+   * @param[out] fullWidth, fullHeight size of the encoded image.
+   * @return false if the data is no valid JPEG.
+   */
+  static bool decode(const unsigned char *data, size_t size, int targetWidth, int targetHeight,
+                     cv::Mat *bgr, int *fullWidth, int *fullHeight);
+};
+
+} /* namespace darknet_ros*/
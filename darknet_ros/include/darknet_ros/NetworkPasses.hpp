@@ -0,0 +1,50 @@
+/*
+ * NetworkPasses.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+// c++
+#include <vector>
+
+extern "C" {
+#include "network.h"
+}
+
+namespace darknet_ros {
+
+/*!
+ * Checks whether a layer produces detections (yolo, region or detection layer).
+ */
+bool isDetectionLayer(const layer& l);
+
+/*!
+ * Drops the detection heads that are not listed, together with every layer that only feeds
+ * them, and renumbers the remaining layers.
+ * @param[in] keep indices of the heads to keep, counted in order of appearance in the cfg.
+ * @return number of removed layers, or -1 if no listed head exists.
+ */
+int pruneDetectionHeads(network *net, const std::vector<int>& keep);
+
+/*!
+ * Physically removes the output channels of convolutional layers whose filters are all zero
+ * and whose output therefore is constant zero, together with the matching input channels of
+ * every downstream consumer. Channel masks are propagated through route, shortcut, upsample
+ * and maxpool layers; a channel is only removed where all layers sharing it agree.
+ * @return number of removed convolution output channels.
+ */
+int pruneZeroChannels(network *net);
+
+/*!
+ * Rewrites route layers so that they no longer copy their inputs. The producers of a
+ * concatenating route (e.g. upsample + shortcut in yolov3) write straight into their channel
+ * slice of the route output, and single-input routes alias their input. The buffers these
+ * layers no longer use are freed; the network then shares buffers between layers and must
+ * not be passed to free_network. Only applies to CPU networks with batch size 1.
+ * @return number of routes that became views.
+ */
+int fuseRouteConcatenations(network *net);
+
+} /* namespace darknet_ros*/
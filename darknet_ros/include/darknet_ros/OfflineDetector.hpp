@@ -0,0 +1,107 @@
+/*
+ * OfflineDetector.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+// c++
+#include <memory>
+#include <string>
+#include <vector>
+
+// darknet_ros
+#include "darknet_ros/DarknetBackend.hpp"
+#include "darknet_ros/DetectionBoxes.hpp"
+#include "darknet_ros/FrameConverter.hpp"
+#include "darknet_ros/InferenceBackend.hpp"
+
+namespace darknet_ros {
+
+//! Detected object, coordinates in pixels of the image it was found in.
+struct OfflineDetection
+{
+  int classId;
+  float probability;
+  float xmin;
+  float ymin;
+  float xmax;
+  float ymax;
+};
+
+/*!
+ * The detection path of the node without ROS, for tools that run over recorded images:
+ * letterboxing, inference backend, and the node's own head selection, non-maximum suppression
+ * and box filtering (DetectionBoxes). It matches the main topics of the node without head
+ * sets and without temporal smoothing, which has no meaning across unrelated images.
+ */
+class OfflineDetector
+{
+ public:
+  struct Options
+  {
+    //! "darknet" or "onnxruntime", as the inference/backend parameter.
+    std::string backend = "darknet";
+    DarknetBackend::Options darknet;
+    //! ONNX Runtime threads and execution provider.
+    int onnxThreads = 0;
+    std::string executionProvider = "cpu";
+    float threshold = .3f;
+    float hier = .5f;
+    //! Overlap of non-maximum suppression, 0 disables it.
+    float nms = DetectionNmsOverlap;
+  };
+
+  explicit OfflineDetector(const Options& options);
+
+  /*!
+   * Loads the model, darknet weights or an ONNX export depending on the backend.
+   * @return false if the backend is not available or could not load the model.
+   */
+  bool load(const std::string& config, const std::string& model);
+
+  const InferenceBackend& backend() const { return *backend_; }
+
+  /*!
+   * Classes of the detection heads.
+   */
+  int classes() const { return classes_; }
+
+  /*!
+   * Allocates an input tensor to letterbox frames into, free with free_image.
+   */
+  image makeInput() const;
+
+  /*!
+   * Letterboxes a frame into an input tensor, the node's fetch stage.
+   */
+  static void fetch(const CameraFrame& frame, image input) { letterboxFrame(frame, input); }
+
+  /*!
+   * Runs the network on an input tensor and decodes the detections, the node's detect stage.
+   * Calls on one detector must not overlap.
+   * @param[in] width, height size of the frame letterboxed into the input.
+   */
+  void detect(image input, int width, int height, std::vector<OfflineDetection> *detections);
+
+ private:
+  Options options_;
+  std::unique_ptr<InferenceBackend> backend_;
+  std::vector<int> heads_;
+  int classes_ = 0;
+  std::vector<FrameBox> boxes_;
+};
+
+/*!
+ * Image files (jpg, jpeg, png, bmp) of a directory, sorted by name.
+ */
+std::vector<std::string> listImages(const std::string& directory);
+
+/*!
+ * Loads an image file as RGB8 camera frame.
+ * @return false if the file cannot be read.
+ */
+bool loadImageFrame(const std::string& file, CameraFrame *frame);
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,72 @@
+/*
+ * OnnxBackend.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+// c++
+#include <memory>
+#include <string>
+#include <vector>
+
+// darknet_ros
+#include "darknet_ros/InferenceBackend.hpp"
+
+namespace darknet_ros {
+
+/*!
+ * Runs the model exported to ONNX with ONNX Runtime on the CPU, optionally through its
+ * OpenVINO execution provider. The graph has to end at the raw head outputs, i.e. the
+ * convolutions feeding the yolo/region layers of the cfg; those layers are still taken from
+ * the cfg to activate and decode the outputs exactly as darknet does.
+ */
+class OnnxBackend : public InferenceBackend
+{
+ public:
+  struct Options
+  {
+    //! Threads of ONNX Runtime's intra-op pool, 0 for its default.
+    int threads = 0;
+    //! "cpu" or "openvino".
+    std::string executionProvider = "cpu";
+  };
+
+  explicit OnnxBackend(const Options& options);
+
+  ~OnnxBackend();
+
+  std::string name() const override { return "onnxruntime"; }
+
+  /*!
+   * Loads the cfg for input size and heads and the ONNX model, and matches every model
+   * output to the head of the same size.
+   */
+  bool load(const std::string& config, const std::string& model) override;
+
+  int inputWidth() const override { return net_->w; }
+  int inputHeight() const override { return net_->h; }
+  int inputChannels() const override { return net_->c; }
+
+  void run(float *input) override;
+
+  const std::vector<DetectionHead>& heads() const override { return heads_; }
+
+  detection *detections(const std::vector<int>& heads, int width, int height, float thresh, float hier,
+                        int *count) override;
+
+ private:
+  struct Session;
+
+  Options options_;
+
+  //! Network of the cfg, only its detection layers run.
+  network *net_ = nullptr;
+  std::vector<DetectionHead> heads_;
+
+  //! ONNX Runtime session, its bindings and the raw output per head.
+  std::unique_ptr<Session> session_;
+};
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,186 @@
+/*
+ * SharedMemoryRing.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+// c++
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace darknet_ros {
+
+//! Payload formats of the rings written by the node.
+const uint32_t HeadTensorsMagic = 0x54484b44;  // "DKHT"
+const uint32_t DetectionsMagic = 0x54454444;  // "DDET"
+
+//! Detections of one frame: a SharedDetections followed by count SharedDetection entries.
+struct SharedDetections
+{
+  //! Header of the image the detections belong to, stamp in nanoseconds.
+  uint64_t imageStamp;
+  uint32_t imageSeq;
+  uint32_t count;
+  char frameId[48];
+};
+
+//! One detected object, coordinates in pixels of the full image.
+struct SharedDetection
+{
+  float xmin;
+  float ymin;
+  float xmax;
+  float ymax;
+  float probability;
+  //! Distance in metres, 0 if unknown.
+  float depth;
+  int32_t classId;
+  uint32_t reserved;
+  char label[32];
+};
+
+static_assert(sizeof(SharedDetections) == 64 && sizeof(SharedDetection) == 64,
+              "The layout of the detection ring is fixed.");
+
+/*!
+ * Ring of fixed size slots in a POSIX shared memory segment (shm_open), written by the node
+ * and read by other processes on the same host without ROS serialization.
+ *
+ * Segment layout: a Header, then slotCount slots of slotStride bytes, each a SlotHeader
+ * followed by up to slotSize bytes of payload. Every slot is a seqlock: its sequence is odd
+ * while the node writes it and even otherwise. A reader notes the sequence, reads the
+ * payload in place and accepts it if the sequence is still the same even value afterwards.
+ * The writer never waits for readers.
+ */
+class SharedMemoryRing
+{
+ public:
+  //! Start of the segment.
+  struct Header
+  {
+    //! Identifies the payload format, set by the writer.
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    //! Maximum payload of a slot in bytes.
+    uint32_t slotSize;
+    //! Distance between slots in bytes, starting at slotsOffset.
+    uint32_t slotStride;
+    uint32_t slotsOffset;
+    //! Slots committed so far, the newest is slot (written - 1) % slotCount.
+    std::atomic<uint64_t> written;
+  };
+
+  //! Start of every slot, the payload follows at the next 64 byte boundary.
+  struct SlotHeader
+  {
+    std::atomic<uint64_t> sequence;
+    //! Time stamp of the payload in nanoseconds.
+    uint64_t stamp;
+    //! Bytes of the payload.
+    uint32_t size;
+  };
+
+  static constexpr uint32_t Version = 1;
+
+  /*!
+   * Creates the segment, replacing one of the same name left behind.
+   * @param[in] name name of the segment as passed to shm_open, starting with a slash.
+   * @param[in] magic format of the payload, checked by readers.
+   */
+  SharedMemoryRing(const std::string& name, uint32_t magic, uint32_t slotCount, size_t slotSize);
+
+  /*!
+   * Unmaps and removes the segment, mappings of readers stay valid.
+   */
+  ~SharedMemoryRing();
+
+  SharedMemoryRing(const SharedMemoryRing&) = delete;
+  SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+  /*!
+   * @return false if the segment could not be created.
+   */
+  bool valid() const { return header_ != nullptr; }
+
+  const std::string& name() const { return name_; }
+  size_t slotSize() const { return slotSize_; }
+
+  /*!
+   * Marks the next slot as being written.
+   * @param[out] slot index of the slot.
+   * @return payload of the slot, slotSize() bytes.
+   */
+  void *beginWrite(uint32_t *slot);
+
+  /*!
+   * Publishes the slot opened by beginWrite.
+   * @return sequence of the slot while it holds this payload.
+   */
+  uint64_t commit(uint64_t stamp, size_t size);
+
+  /*!
+   * Bytes from the start of the segment to the payload of a slot.
+   */
+  size_t payloadOffset(uint32_t slot) const;
+
+ private:
+  std::string name_;
+  size_t slotSize_;
+  size_t mappedSize_ = 0;
+  Header *header_ = nullptr;
+  uint32_t writing_ = 0;
+};
+
+/*!
+ * Read access to a SharedMemoryRing from another process.
+ */
+class SharedMemoryRingReader
+{
+ public:
+  SharedMemoryRingReader() = default;
+  ~SharedMemoryRingReader();
+
+  SharedMemoryRingReader(const SharedMemoryRingReader&) = delete;
+  SharedMemoryRingReader& operator=(const SharedMemoryRingReader&) = delete;
+
+  /*!
+   * Maps the segment read-only.
+   * @return false if it does not exist or holds another format or version.
+   */
+  bool open(const std::string& name, uint32_t magic);
+
+  const SharedMemoryRing::Header *header() const { return header_; }
+
+  /*!
+   * Payload of a slot, only valid while unchanged(slot, sequence) holds.
+   */
+  const void *payload(uint32_t slot) const;
+
+  /*!
+   * Sequence of a slot to pass to unchanged() once its payload is read, odd while written.
+   */
+  uint64_t sequence(uint32_t slot) const;
+
+  /*!
+   * @return true if the slot still holds the payload it held at the given even sequence.
+   */
+  bool unchanged(uint32_t slot, uint64_t sequence) const;
+
+  /*!
+   * Copies the newest complete payload.
+   * @param[out] stamp time stamp of the payload.
+   * @return bytes copied, 0 if nothing was written yet or the copy raced the writer.
+   */
+  size_t readLatest(void *buffer, size_t size, uint64_t *stamp = nullptr) const;
+
+ private:
+  const SharedMemoryRing::Header *header_ = nullptr;
+  size_t mappedSize_ = 0;
+};
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,145 @@
+/*
+ * Simd.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace darknet_ros {
+
+/*!
+ * Thin wrapper over the float vector type of the target (AVX2, SSE2, NEON or plain float), so
+ * kernels are written once and compiled for whatever the build enables.
+ */
+namespace simd {
+
+#if defined(__AVX2__)
+
+typedef __m256 Float;
+const int width = 8;
+
+inline Float load(const float *p) { return _mm256_loadu_ps(p); }
+inline void store(float *p, Float v) { _mm256_storeu_ps(p, v); }
+inline Float set(float v) { return _mm256_set1_ps(v); }
+inline Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+inline Float sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+inline Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+inline Float div(Float a, Float b) { return _mm256_div_ps(a, b); }
+inline Float max(Float a, Float b) { return _mm256_max_ps(a, b); }
+inline Float min(Float a, Float b) { return _mm256_min_ps(a, b); }
+inline Float floor(Float a) { return _mm256_floor_ps(a); }
+inline Float greater(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+inline Float select(Float mask, Float a, Float b) { return _mm256_blendv_ps(b, a, mask); }
+inline Float pow2(Float n)
+{
+  const __m256i exponent = _mm256_add_epi32(_mm256_cvttps_epi32(n), _mm256_set1_epi32(127));
+  return _mm256_castsi256_ps(_mm256_slli_epi32(exponent, 23));
+}
+
+#elif defined(__SSE2__)
+
+typedef __m128 Float;
+const int width = 4;
+
+inline Float load(const float *p) { return _mm_loadu_ps(p); }
+inline void store(float *p, Float v) { _mm_storeu_ps(p, v); }
+inline Float set(float v) { return _mm_set1_ps(v); }
+inline Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+inline Float sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+inline Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+inline Float div(Float a, Float b) { return _mm_div_ps(a, b); }
+inline Float max(Float a, Float b) { return _mm_max_ps(a, b); }
+inline Float min(Float a, Float b) { return _mm_min_ps(a, b); }
+inline Float greater(Float a, Float b) { return _mm_cmpgt_ps(a, b); }
+inline Float select(Float mask, Float a, Float b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+inline Float floor(Float a)
+{
+  // Truncation rounds towards zero; step down where that went up.
+  const Float truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+  return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a), _mm_set1_ps(1.f)));
+}
+inline Float pow2(Float n)
+{
+  const __m128i exponent = _mm_add_epi32(_mm_cvttps_epi32(n), _mm_set1_epi32(127));
+  return _mm_castsi128_ps(_mm_slli_epi32(exponent, 23));
+}
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+typedef float32x4_t Float;
+const int width = 4;
+
+inline Float load(const float *p) { return vld1q_f32(p); }
+inline void store(float *p, Float v) { vst1q_f32(p, v); }
+inline Float set(float v) { return vdupq_n_f32(v); }
+inline Float add(Float a, Float b) { return vaddq_f32(a, b); }
+inline Float sub(Float a, Float b) { return vsubq_f32(a, b); }
+inline Float mul(Float a, Float b) { return vmulq_f32(a, b); }
+inline Float div(Float a, Float b) { return vdivq_f32(a, b); }
+inline Float max(Float a, Float b) { return vmaxq_f32(a, b); }
+inline Float min(Float a, Float b) { return vminq_f32(a, b); }
+inline Float floor(Float a) { return vrndmq_f32(a); }
+inline Float greater(Float a, Float b) { return vreinterpretq_f32_u32(vcgtq_f32(a, b)); }
+inline Float select(Float mask, Float a, Float b) { return vbslq_f32(vreinterpretq_u32_f32(mask), a, b); }
+inline Float pow2(Float n)
+{
+  const int32x4_t exponent = vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127));
+  return vreinterpretq_f32_s32(vshlq_n_s32(exponent, 23));
+}
+
+#else
+
+typedef float Float;
+const int width = 1;
+
+inline Float load(const float *p) { return *p; }
+inline void store(float *p, Float v) { *p = v; }
+inline Float set(float v) { return v; }
+inline Float add(Float a, Float b) { return a + b; }
+inline Float sub(Float a, Float b) { return a - b; }
+inline Float mul(Float a, Float b) { return a * b; }
+inline Float div(Float a, Float b) { return a / b; }
+inline Float max(Float a, Float b) { return a > b ? a : b; }
+inline Float min(Float a, Float b) { return a < b ? a : b; }
+inline Float floor(Float a) { return (float) (a < 0 && (int) a != a ? (int) a - 1 : (int) a); }
+inline Float greater(Float a, Float b) { return a > b ? 1.f : 0.f; }
+inline Float select(Float mask, Float a, Float b) { return mask != 0 ? a : b; }
+inline Float pow2(Float n)
+{
+  union { int i; float f; } value;
+  value.i = ((int) n + 127) << 23;
+  return value.f;
+}
+
+#endif
+
+/*!
+ * e^x, Cephes style: range reduction to [-ln2/2, ln2/2] and a degree 6 polynomial.
+ */
+inline Float exp(Float x)
+{
+  x = min(max(x, set(-87.3365447f)), set(88.3762626f));
+  const Float n = floor(add(mul(x, set(1.44269504088896341f)), set(.5f)));
+  x = sub(sub(x, mul(n, set(0.693359375f))), mul(n, set(-2.12194440e-4f)));
+  Float y = set(1.9875691500e-4f);
+  y = add(mul(y, x), set(1.3981999507e-3f));
+  y = add(mul(y, x), set(8.3334519073e-3f));
+  y = add(mul(y, x), set(4.1665795894e-2f));
+  y = add(mul(y, x), set(1.6666665459e-1f));
+  y = add(mul(y, x), set(5.0000001201e-1f));
+  y = add(add(mul(y, mul(x, x)), x), set(1.f));
+  return mul(y, pow2(n));
+}
+
+} /* namespace simd*/
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,152 @@
+/*
+ * TaskScheduler.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+// c++
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace darknet_ros {
+
+//! Lanes of the task scheduler.
+enum class TaskPriority
+{
+  Critical,   // inference path, always taken first
+  Normal
+};
+
+/*!
+ * Work-stealing thread pool shared by every stage of the detector. Tasks submitted by a
+ * worker go to its own deque and are taken back last in, first out; idle workers steal the
+ * oldest tasks of the others. Critical tasks bypass the deques through a shared lane that
+ * every worker checks first.
+ *
+ * Threads waiting for tasks (TaskGroup::wait) run queued tasks meanwhile, so nested parallel
+ * loops never block a worker and the waiting thread counts as one of the cores. Waiters of a
+ * critical group only run critical tasks, so the inference path never picks up normal work
+ * such as frame decoding while it waits.
+ *
+ * A scheduler for a single core has no workers: submit() runs the task on the calling thread
+ * and waiters run the tasks of their groups themselves.
+ */
+class TaskScheduler
+{
+ public:
+  /*!
+   * Constructor.
+   * @param[in] threads cores to use including the thread that waits for the tasks, 0 for
+   * every core the process may run on. It starts threads - 1 workers.
+   */
+  explicit TaskScheduler(int threads);
+
+  /*!
+   * Destructor, finishes the running tasks and drops the queued ones.
+   */
+  ~TaskScheduler();
+
+  /*!
+   * Cores the scheduler uses, its workers plus one waiting thread.
+   */
+  int concurrency() const { return static_cast<int>(workers_.size()) + 1; }
+
+  /*!
+   * Queues a task, or runs it right away if there are no workers.
+   */
+  void submit(const std::function<void()>& task, TaskPriority priority = TaskPriority::Normal);
+
+  /*!
+   * Runs body over [begin, end) in chunks of at least grain iterations and returns when all
+   * chunks are done. The calling thread runs a chunk itself.
+   */
+  void parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body,
+                   TaskPriority priority = TaskPriority::Critical);
+
+  /*!
+   * Makes the scheduler the one used by darknet_ros::parallelFor, nullptr for none.
+   */
+  static void setDefault(TaskScheduler *scheduler);
+
+  /*!
+   * Number of cores the process is allowed to run on.
+   */
+  static int allottedCores();
+
+ private:
+  friend class TaskGroup;
+
+  struct Worker
+  {
+    std::mutex mutex;
+    std::deque<std::function<void()> > tasks;
+  };
+
+  void run(int index);
+
+  /*!
+   * Takes and runs one queued task.
+   * @param[in] criticalOnly take only tasks of the critical lane.
+   * @return false if there was none.
+   */
+  bool runOne(int self, bool criticalOnly = false);
+
+  bool take(int self, bool criticalOnly, std::function<void()> *task);
+
+  //! Waits until a task it may take is queued or predicate holds.
+  void idle(bool criticalOnly, const std::function<bool()>& predicate);
+
+  void notifyAll();
+
+  std::vector<std::unique_ptr<Worker> > workers_;
+  std::vector<std::thread> threads_;
+  std::deque<std::function<void()> > critical_;
+  std::deque<std::function<void()> > injected_;
+  std::atomic<int> queued_{0};
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  //! Waiters of critical groups, not woken by normal tasks.
+  std::condition_variable criticalCondition_;
+  bool stopping_ = false;
+};
+
+/*!
+ * Set of tasks that can be waited for together.
+ */
+class TaskGroup
+{
+ public:
+  TaskGroup(TaskScheduler& scheduler, TaskPriority priority);
+
+  //! Waits for the remaining tasks.
+  ~TaskGroup();
+
+  void run(const std::function<void()>& task);
+
+  /*!
+   * Runs queued tasks until all tasks of this group are done: critical tasks only if this is
+   * a critical group, tasks of any lane otherwise.
+   */
+  void wait();
+
+ private:
+  TaskScheduler& scheduler_;
+  TaskPriority priority_;
+  std::shared_ptr<std::atomic<int> > pending_;
+};
+
+/*!
+ * parallelFor on the default scheduler on the critical lane, or a plain loop if there is no
+ * default scheduler.
+ */
+void parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body);
+
+} /* namespace darknet_ros*/
@@ -10,6 +10,7 @@
 
 // c++
 #include <algorithm>
+#include <atomic>
 #include <math.h>
 #include <string>
 #include <vector>
@@ -17,24 +18,34 @@
 #include <pthread.h>
 #include <thread>
 #include <chrono>
-#include <semaphore.h>
+#include <deque>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
 
 // ROS
 #include <ros/ros.h>
+#include <ros/callback_queue.h>
 #include <std_msgs/Header.h>
 #include <std_msgs/Int8.h>
+#include <actionlib/server/action_server.h>
 #include <actionlib/server/simple_action_server.h>
 #include <sensor_msgs/image_encodings.h>
 #include <sensor_msgs/Image.h>
+#include <sensor_msgs/CompressedImage.h>
 #include <geometry_msgs/Point.h>
 #include <image_transport/image_transport.h>
 #include <image_transport/subscriber_filter.h>
+#include <message_filters/subscriber.h>
 #include <message_filters/synchronizer.h>
 #include <message_filters/sync_policies/approximate_time.h>
 
 // OpenCv
+#include <opencv2/core/core_c.h>
+#include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
-#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc_c.h>
 #include <opencv2/objdetect/objdetect.hpp>
 #include <cv_bridge/cv_bridge.h>
 
@@ -42,6 +53,20 @@
 #include <darknet_ros_msgs/BoundingBoxes.h>
 #include <darknet_ros_msgs/BoundingBox.h>
 #include <darknet_ros_msgs/CheckForObjectsAction.h>
+#include <darknet_ros_msgs/HeadTensors.h>
+
+// darknet_ros
+#include "darknet_ros/BoundingBoxesBuffer.hpp"
+#include "darknet_ros/BoxTracker.hpp"
+#include "darknet_ros/DepthFrame.hpp"
+#include "darknet_ros/DetectionBoxes.hpp"
+#include "darknet_ros/DetectionViewer.hpp"
+#include "darknet_ros/FrameConverter.hpp"
+#include "darknet_ros/FrameScheduler.hpp"
+#include "darknet_ros/InferenceBackend.hpp"
+#include "darknet_ros/JpegDecoder.hpp"
+#include "darknet_ros/SharedMemoryRing.hpp"
+#include "darknet_ros/TaskScheduler.hpp"
 
 // Darknet.
 #ifdef GPU
@@ -62,10 +87,6 @@ extern "C" {
 #include <sys/time.h>
 }
 
-extern "C" void ipl_into_image(IplImage* src, image im);
-extern "C" image ipl_to_image(IplImage* src);
-extern "C" void show_image_cv(image p, const char *name, IplImage *disp, const bool display_img);
-
 namespace darknet_ros {
 
 //! Bounding box of the detected object.
@@ -75,12 +96,6 @@ typedef struct
   int num, Class;
 } RosBox_;
 
-typedef struct
-{
-  IplImage* image;
-  std_msgs::Header header;
-} IplImageWithHeader_;
-
 class YoloObjectDetector
 {
  public:
@@ -115,6 +130,34 @@ class YoloObjectDetector
                          const sensor_msgs::ImageConstPtr& dmap_msg
   );
 
+  /*!
+   * Callback of a compressed camera topic, queues the frame for decoding.
+   * @param[in] img_msg compressed image pointer.
+   * @param[in] dmap_msg depth map pointer.
+   */
+  void compressedCameraCallback(const sensor_msgs::CompressedImageConstPtr& img_msg,
+                                const sensor_msgs::ImageConstPtr& dmap_msg);
+
+  /*!
+   * Decodes a compressed frame at reduced size and queues it as the current image.
+   */
+  void decodeCompressedFrame(const sensor_msgs::CompressedImageConstPtr& img_msg,
+                             const sensor_msgs::ImageConstPtr& dmap_msg);
+
+  /*!
+   * Task decoding the oldest queued compressed frame. Submits the task for the next one, so
+   * every frame is a task of its own and no waiting thread drains the queue.
+   */
+  void decodeNextFrame();
+
+  /*!
+   * Checks a frame against the maximum frame age and counts it if it is too old.
+   * @param[in] header header of the frame.
+   * @param[in] counter counter of the stage that checks.
+   * @return true if the frame has to be dropped.
+   */
+  bool isStale(const std_msgs::Header& header, std::atomic<unsigned long> *counter);
+
   /*!
    * Check for objects action goal callback.
    */
@@ -131,25 +174,66 @@ class YoloObjectDetector
    */
   bool isCheckingForObjects() const;
 
+  //! Typedefs.
+  typedef actionlib::SimpleActionServer<darknet_ros_msgs::CheckForObjectsAction> CheckForObjectsActionServer;
+  typedef std::shared_ptr<CheckForObjectsActionServer> CheckForObjectsActionServerPtr;
+  typedef actionlib::ActionServer<darknet_ros_msgs::CheckForObjectsAction> CheckForObjectsBatchServer;
+  typedef CheckForObjectsBatchServer::GoalHandle CheckForObjectsBatchGoal;
+
+  /*!
+   * Batch action goal callback, queues the image of the goal.
+   */
+  void checkForObjectsBatchGoalCB(CheckForObjectsBatchGoal goal);
+
+  /*!
+   * Batch action cancel callback.
+   */
+  void checkForObjectsBatchCancelCB(CheckForObjectsBatchGoal goal);
+
+  /*!
+   * Sends the result of an action frame to the goal it answers, if that goal still waits.
+   */
+  void sendActionResult(const ScheduledFrame& frame, const darknet_ros_msgs::CheckForObjectsResult& result);
+
+  /*!
+   * Logs the queueing delay of each frame class once per statistics period.
+   */
+  void reportQueueingDelays();
+
   /*!
    * Publishes the detection image.
    * @return true if successful.
    */
   bool publishDetectionImage(const cv::Mat& detectionImage);
 
-  //! Typedefs.
-  typedef actionlib::SimpleActionServer<darknet_ros_msgs::CheckForObjectsAction> CheckForObjectsActionServer;
-  typedef std::shared_ptr<CheckForObjectsActionServer> CheckForObjectsActionServerPtr;
-
   //! ROS node handle.
   ros::NodeHandle nodeHandle_;
 
+  //! Callback queues of camera frames (images and depth maps) and actions, each spun apart.
+  ros::CallbackQueue cameraQueue_;
+  ros::CallbackQueue actionQueue_;
+  ros::NodeHandle cameraNodeHandle_;
+  ros::NodeHandle actionNodeHandle_;
+  std::vector<std::shared_ptr<ros::AsyncSpinner> > spinners_;
+
   //! Class labels.
   int numClasses_;
   std::vector<std::string> classLabels_;
 
   //! Check for objects action server.
   CheckForObjectsActionServerPtr checkForObjectsActionServer_;
+  std::atomic<unsigned long> goalTicket_{0};
+
+  //! Batch action server, its goals wait in the batch class.
+  std::shared_ptr<CheckForObjectsBatchServer> checkForObjectsBatchServer_;
+  std::map<unsigned long, CheckForObjectsBatchGoal> batchGoals_;
+  boost::shared_mutex mutexBatchGoals_;
+  std::atomic<unsigned long> nextTicket_{0};
+
+  //! Orders live frames and action goals for the network.
+  FrameScheduler scheduler_;
+  double statisticsPeriod_;
+  double lastStatistics_ = 0;
 
   //! Advertise and subscribe to image topics.
   image_transport::ImageTransport imageTransport_;
@@ -166,14 +250,39 @@ class YoloObjectDetector
   > ApproxTimePolicy;
   message_filters::Synchronizer<ApproxTimePolicy> imgSync_;
 
-  //! Detected objects.
-  std::vector<std::vector<RosBox_> > rosBoxes_;
-  std::vector<int> rosBoxCounter_;
-  darknet_ros_msgs::BoundingBoxes boundingBoxesResults_;
+  //! Compressed camera input.
+  typedef message_filters::sync_policies::ApproximateTime<
+    sensor_msgs::CompressedImage, sensor_msgs::Image
+  > CompressedApproxTimePolicy;
+  bool compressedInput_;
+  int decodeThreads_;
+  message_filters::Subscriber<sensor_msgs::CompressedImage> compressedSubscriber_;
+  std::shared_ptr<message_filters::Synchronizer<CompressedApproxTimePolicy> > compressedSync_;
+  std::deque<std::pair<sensor_msgs::CompressedImageConstPtr, sensor_msgs::ImageConstPtr> > pendingDecodes_;
+  int runningDecodes_ = 0;
+  std::mutex mutexDecodes_;
+
+  //! Threads of all parallel work of the node: pipeline stages, kernels and decoding.
+  std::shared_ptr<TaskScheduler> taskScheduler_;
+
+  //! Frames older than this many seconds are dropped, 0 disables the check.
+  double maxFrameAge_;
+  std::atomic<unsigned long> staleAtAdmission_{0};
+  std::atomic<unsigned long> staleBeforeInference_{0};
+
+  //! Detected objects, refilled for every frame without allocating.
+  BoundingBoxesBuffer boundingBoxesResults_;
+
+  //! Change driven publishing: unchanged detections only renew the heartbeat.
+  bool changeDriven_ = false;
+  double changeMinOverlap_;
+  double changeScoreDelta_;
+  double keepAlive_;
+  ros::Time lastFullPublish_;
+  std::vector<darknet_ros_msgs::BoundingBox> publishedBoxes_;
+  ros::Publisher heartbeatPublisher_;
 
   //! Camera related parameters.
-  int frameWidth_;
-  int frameHeight_;
   bool zed;
 
   //! Publisher of the bounding box image.
@@ -187,66 +296,146 @@ class YoloObjectDetector
   image **demoAlphabet_;
   int demoClasses_;
 
-  network *net_;
-  std_msgs::Header headerBuff_[3];
+  //! Engine running the model, darknet unless configured otherwise.
+  std::unique_ptr<InferenceBackend> backend_;
+
+  //! Detection heads on the shared backbone with their own classes and topic.
+  struct HeadSet
+  {
+    std::string name;
+    std::vector<int> heads;
+    int classes = 0;
+    std::vector<std::string> classLabels;
+    ros::Publisher publisher;
+    //! Detections per pipeline slot, written by detect and read by publish.
+    darknet_ros_msgs::BoundingBoxes results[3];
+    //! Boxes of the frame being decoded.
+    std::vector<FrameBox> boxes;
+  };
+  std::vector<HeadSet> headSets_;
+
+  //! Heads served by the main topics and actions, those not taken by a head set.
+  std::vector<int> primaryHeads_;
+  int primaryClasses_ = 0;
+  //! Boxes of the main heads of the frame being detected.
+  std::vector<FrameBox> frameBoxes_;
+
+  //! Head outputs of live frames in shared memory, announced on a topic.
+  std::unique_ptr<SharedMemoryRing> headTensorRing_;
+  ros::Publisher headTensorsPublisher_;
+  darknet_ros_msgs::HeadTensors headTensors_;
+
+  //! Detections of live frames in shared memory for readers on the same host.
+  std::unique_ptr<SharedMemoryRing> detectionRing_;
+  int detectionRingCapacity_ = 0;
+
+  ScheduledFrame buffFrame_[3];
+  bool buffValid_[3] = {false, false, false};
   image buff_[3];
   image buffLetter_[3];
-  int buffId_[3];
   int buffIndex_ = 0;
   IplImage * ipl_;
   float fps_ = 0;
-  float demoThresh_ = 0;
-  float demoHier_ = .5;
+  //! Changed from the keyboard of the viewer thread.
+  std::atomic<float> demoThresh_{0};
+  std::atomic<float> demoHier_{.5};
   int running_ = 0;
 
   int demoDelay_ = 0;
   int demoFrame_ = 3;
   float **predictions_;
   int demoIndex_ = 0;
-  int demoDone_ = 0;
+  std::atomic<int> demoDone_{0};
   float *lastAvg2_;
   float *lastAvg_;
   float *avg_;
   int demoTotal_ = 0;
   double demoTime_;
 
-  RosBox_ *roiBoxes_;
+  //! Smoothing of the decoded live detections, instead of averaging the head outputs.
+  std::unique_ptr<BoxTracker> boxTracker_;
+
+  //! Detected objects per pipeline slot, written by detect and read by publish.
+  RosBox_ *roiBoxes_[3];
+  int roiBoxesCapacity_;
   bool viewImage_;
+  double viewRate_;
+  std::unique_ptr<DetectionViewer> viewer_;
   bool enableConsoleOutput_;
   int waitKeyDelay_;
   int fullScreen_;
   char *demoPrefix_;
 
+  //! Header of the newest live frame, decoders may finish out of order.
   std_msgs::Header imageHeader_;
-  cv::Mat camImageCopy_;
-  cv::Mat camDmapCopy_;
   boost::shared_mutex mutexImageCallback_;
 
-  bool imageStatus_ = false;
-  boost::shared_mutex mutexImageStatus_;
-
   bool isNodeRunning_ = true;
   boost::shared_mutex mutexNodeStatus_;
 
-  int actionId_;
-  boost::shared_mutex mutexActionStatus_;
-
   // double getWallTime();
 
-  int sizeNetwork(network *net);
+  int sizeNetwork();
+
+  void rememberNetwork();
+
+  detection *avgPredictions(int width, int height, int *nboxes);
+
+  /*!
+   * Replaces detections by the tracks of boxTracker_ they continue.
+   * @return detections of the tracks, the input is freed.
+   */
+  detection *trackDetections(detection *dets, int *nboxes);
+
+  float getObjDepth(const DepthFrame& depth, float xmin, float xmax, float ymin, float ymax);
+
+  /*!
+   * Reads the head sets and assigns the remaining heads to the main topics.
+   */
+  void setupHeadSets();
+
+  /*!
+   * Decodes the heads of a head set for the frame in a pipeline slot.
+   */
+  void detectHeadSet(HeadSet& set, const ScheduledFrame& frame, int slot);
+
+  /*!
+   * Creates the shared memory ring of head outputs if enabled.
+   */
+  void setupHeadTensors();
 
-  void rememberNetwork(network *net);
+  /*!
+   * Copies the head outputs of the frame into the ring and announces them.
+   */
+  void exportHeadTensors(const ScheduledFrame& frame);
+
+  /*!
+   * Creates the shared memory ring of detections if enabled.
+   */
+  void setupDetectionRing();
 
-  detection *avgPredictions(network *net, int *nboxes);
+  /*!
+   * Writes the detected objects of the frame into the ring.
+   */
+  void writeDetectionRing(const ScheduledFrame& frame, const RosBox_ *boxes, int num);
 
-  float getObjDepth(float xmin, float xmax, float ymin, float ymax);
+  /*!
+   * Compares the detections of the frame with the last published ones.
+   * @return true if they have to be published in full, they become the last published ones.
+   */
+  bool detectionsChanged();
 
   void *detectInThread();
 
-  void *fetchInThread();
+  void *fetchInThread(const ScheduledFrame *frame);
 
   void *displayInThread(void *ptr);
 
+  /*!
+   * Applies a key pressed in the viewer window.
+   */
+  void handleKey(int key);
+
   void *displayLoop(void *ptr);
 
   void *detectLoop(void *ptr);
@@ -258,10 +447,6 @@ class YoloObjectDetector
 
   void yolo();
 
-  IplImageWithHeader_ getIplImageWithHeader();
-
-  bool getImageStatus(void);
-
   bool isNodeRunning(void);
 
   void *publishInThread();
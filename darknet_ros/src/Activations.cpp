@@ -0,0 +1,271 @@
+/*
+ * Activations.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "darknet_ros/Activations.hpp"
+#include "darknet_ros/Simd.hpp"
+
+// c++
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include "activations.h"
+#include "blas.h"
+#include "shortcut_layer.h"
+#include "yolo_layer.h"
+}
+
+namespace darknet_ros {
+
+namespace {
+
+using simd::Float;
+
+// One functor per darknet activation, following the formulas of activations.h.
+
+struct Linear
+{
+  Float operator()(Float x) const { return x; }
+};
+
+struct Logistic
+{
+  Float operator()(Float x) const
+  {
+    return simd::div(simd::set(1.f), simd::add(simd::set(1.f), simd::exp(simd::sub(simd::set(0.f), x))));
+  }
+};
+
+struct Loggy
+{
+  Float operator()(Float x) const
+  {
+    return simd::sub(simd::mul(simd::set(2.f), Logistic()(x)), simd::set(1.f));
+  }
+};
+
+struct Tanh
+{
+  Float operator()(Float x) const
+  {
+    return simd::sub(simd::mul(simd::set(2.f), Logistic()(simd::add(x, x))), simd::set(1.f));
+  }
+};
+
+struct Relu
+{
+  Float operator()(Float x) const { return simd::max(x, simd::set(0.f)); }
+};
+
+struct Leaky
+{
+  Float operator()(Float x) const { return simd::max(x, simd::mul(x, simd::set(.1f))); }
+};
+
+struct Relie
+{
+  Float operator()(Float x) const { return simd::max(x, simd::mul(x, simd::set(.01f))); }
+};
+
+struct Ramp
+{
+  Float operator()(Float x) const
+  {
+    return simd::add(simd::max(x, simd::set(0.f)), simd::mul(x, simd::set(.1f)));
+  }
+};
+
+struct Elu
+{
+  Float operator()(Float x) const
+  {
+    const Float negative = simd::sub(simd::exp(x), simd::set(1.f));
+    return simd::select(simd::greater(simd::set(0.f), x), negative, x);
+  }
+};
+
+struct Selu
+{
+  Float operator()(Float x) const
+  {
+    const Float negative = simd::mul(simd::set(1.0507f * 1.6732f), simd::sub(simd::exp(x), simd::set(1.f)));
+    return simd::select(simd::greater(simd::set(0.f), x), negative, simd::mul(x, simd::set(1.0507f)));
+  }
+};
+
+struct Plse
+{
+  Float operator()(Float x) const
+  {
+    const Float low = simd::mul(simd::set(.01f), simd::add(x, simd::set(4.f)));
+    const Float high = simd::add(simd::mul(simd::set(.01f), simd::sub(x, simd::set(4.f))), simd::set(1.f));
+    const Float middle = simd::add(simd::mul(simd::set(.125f), x), simd::set(.5f));
+    const Float y = simd::select(simd::greater(simd::set(-4.f), x), low, middle);
+    return simd::select(simd::greater(x, simd::set(4.f)), high, y);
+  }
+};
+
+struct Hardtan
+{
+  Float operator()(Float x) const { return simd::min(simd::max(x, simd::set(-1.f)), simd::set(1.f)); }
+};
+
+struct Lhtan
+{
+  Float operator()(Float x) const
+  {
+    const Float low = simd::mul(simd::set(.001f), x);
+    const Float high = simd::add(simd::mul(simd::set(.001f), simd::sub(x, simd::set(1.f))), simd::set(1.f));
+    const Float y = simd::select(simd::greater(simd::set(0.f), x), low, x);
+    return simd::select(simd::greater(x, simd::set(1.f)), high, y);
+  }
+};
+
+template <typename Op>
+void applyActivation(float *x, int n)
+{
+  const Op op;
+  int i = 0;
+  for (; i + simd::width <= n; i += simd::width) {
+    simd::store(x + i, op(simd::load(x + i)));
+  }
+  if (i == n) return;
+
+  // The tail goes through a padded copy so it needs no scalar version of the functor.
+  float tail[simd::width] = {0};
+  std::copy(x + i, x + n, tail);
+  simd::store(tail, op(simd::load(tail)));
+  std::copy(tail, tail + (n - i), x + i);
+}
+
+template <typename Op>
+void applyAffineActivation(float *x, int n, float scale, float shift)
+{
+  const Op op;
+  const Float a = simd::set(scale);
+  const Float b = simd::set(shift);
+  int i = 0;
+  for (; i + simd::width <= n; i += simd::width) {
+    simd::store(x + i, op(simd::add(simd::mul(simd::load(x + i), a), b)));
+  }
+  if (i == n) return;
+
+  float tail[simd::width] = {0};
+  std::copy(x + i, x + n, tail);
+  simd::store(tail, op(simd::add(simd::mul(simd::load(tail), a), b)));
+  std::copy(tail, tail + (n - i), x + i);
+}
+
+void applyNothing(float *x, int n)
+{
+}
+
+void applyStair(float *x, int n)
+{
+  activate_array(x, n, STAIR);
+}
+
+void applyAffineStair(float *x, int n, float scale, float shift)
+{
+  for (int i = 0; i < n; ++i) {
+    x[i] = activate(x[i] * scale + shift, STAIR);
+  }
+}
+
+int yoloEntryIndex(const layer& l, int batch, int location, int entry)
+{
+  const int n = location / (l.w * l.h);
+  const int loc = location % (l.w * l.h);
+  return batch * l.outputs + n * l.w * l.h * (4 + l.classes + 1) + entry * l.w * l.h + loc;
+}
+
+/*
+ * forward_yolo_layer for inference: same sigmoids, without clearing the delta buffer that only
+ * training reads.
+ */
+void forwardYoloVectorized(layer l, network net)
+{
+  if (net.train) {
+    forward_yolo_layer(l, net);
+    return;
+  }
+  std::memcpy(l.output, net.input, l.outputs * l.batch * sizeof(float));
+  const ActivationKernel logistic = activationKernel(LOGISTIC);
+  for (int b = 0; b < l.batch; ++b) {
+    for (int n = 0; n < l.n; ++n) {
+      logistic(l.output + yoloEntryIndex(l, b, n * l.w * l.h, 0), 2 * l.w * l.h);
+      logistic(l.output + yoloEntryIndex(l, b, n * l.w * l.h, 4), (1 + l.classes) * l.w * l.h);
+    }
+  }
+}
+
+void forwardShortcutVectorized(layer l, network net)
+{
+  copy_cpu(l.outputs * l.batch, net.input, 1, l.output, 1);
+  shortcut_cpu(l.batch, l.w, l.h, l.c, net.layers[l.index].output, l.out_w, l.out_h, l.out_c, l.alpha, l.beta,
+               l.output);
+  activationKernel(l.activation)(l.output, l.outputs * l.batch);
+}
+
+} /* namespace */
+
+ActivationKernel activationKernel(ACTIVATION a)
+{
+  switch (a) {
+    case LINEAR: return applyNothing;
+    case LOGISTIC: return applyActivation<Logistic>;
+    case LOGGY: return applyActivation<Loggy>;
+    case TANH: return applyActivation<Tanh>;
+    case RELU: return applyActivation<Relu>;
+    case LEAKY: return applyActivation<Leaky>;
+    case RELIE: return applyActivation<Relie>;
+    case RAMP: return applyActivation<Ramp>;
+    case ELU: return applyActivation<Elu>;
+    case SELU: return applyActivation<Selu>;
+    case PLSE: return applyActivation<Plse>;
+    case HARDTAN: return applyActivation<Hardtan>;
+    case LHTAN: return applyActivation<Lhtan>;
+    default: return applyStair;
+  }
+}
+
+AffineActivationKernel affineActivationKernel(ACTIVATION a)
+{
+  switch (a) {
+    case LINEAR: return applyAffineActivation<Linear>;
+    case LOGISTIC: return applyAffineActivation<Logistic>;
+    case LOGGY: return applyAffineActivation<Loggy>;
+    case TANH: return applyAffineActivation<Tanh>;
+    case RELU: return applyAffineActivation<Relu>;
+    case LEAKY: return applyAffineActivation<Leaky>;
+    case RELIE: return applyAffineActivation<Relie>;
+    case RAMP: return applyAffineActivation<Ramp>;
+    case ELU: return applyAffineActivation<Elu>;
+    case SELU: return applyAffineActivation<Selu>;
+    case PLSE: return applyAffineActivation<Plse>;
+    case HARDTAN: return applyAffineActivation<Hardtan>;
+    case LHTAN: return applyAffineActivation<Lhtan>;
+    default: return applyAffineStair;
+  }
+}
+
+int installVectorizedActivations(network *net)
+{
+  int installed = 0;
+  for (int i = 0; i < net->n; ++i) {
+    layer& l = net->layers[i];
+    if (l.type == YOLO && l.forward == forward_yolo_layer) {
+      l.forward = forwardYoloVectorized;
+      ++installed;
+    } else if (l.type == SHORTCUT && l.forward == forward_shortcut_layer) {
+      l.forward = forwardShortcutVectorized;
+      ++installed;
+    }
+  }
+  return installed;
+}
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,75 @@
+/*
+ * BoxTracker.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "darknet_ros/BoxTracker.hpp"
+
+// c++
+#include <algorithm>
+
+namespace darknet_ros {
+
+BoxTracker::BoxTracker(const Options& options)
+    : options_(options)
+{
+}
+
+void BoxTracker::update(std::vector<TrackedBox> *boxes, float thresh)
+{
+  // Candidate continuations of the same class, best overlap first.
+  struct Match
+  {
+    float overlap;
+    int track;
+    int box;
+  };
+  std::vector<Match> matches;
+  for (int t = 0; t < (int) tracks_.size(); ++t) {
+    for (int b = 0; b < (int) boxes->size(); ++b) {
+      if (tracks_[t].box.classId != (*boxes)[b].classId) continue;
+      const float overlap = box_iou(tracks_[t].box.bbox, (*boxes)[b].bbox);
+      if (overlap >= options_.minOverlap) matches.push_back({overlap, t, b});
+    }
+  }
+  std::sort(matches.begin(), matches.end(), [](const Match& a, const Match& b) { return a.overlap > b.overlap; });
+
+  const float alpha = options_.alpha;
+  std::vector<bool> trackMatched(tracks_.size(), false);
+  std::vector<bool> boxMatched(boxes->size(), false);
+  for (const Match& match : matches) {
+    if (trackMatched[match.track] || boxMatched[match.box]) continue;
+    trackMatched[match.track] = true;
+    boxMatched[match.box] = true;
+    TrackedBox& smoothed = tracks_[match.track].box;
+    const TrackedBox& observed = (*boxes)[match.box];
+    smoothed.bbox.x += alpha * (observed.bbox.x - smoothed.bbox.x);
+    smoothed.bbox.y += alpha * (observed.bbox.y - smoothed.bbox.y);
+    smoothed.bbox.w += alpha * (observed.bbox.w - smoothed.bbox.w);
+    smoothed.bbox.h += alpha * (observed.bbox.h - smoothed.bbox.h);
+    smoothed.prob += alpha * (observed.prob - smoothed.prob);
+    tracks_[match.track].misses = 0;
+  }
+
+  // Missed tracks fade out: their score averages towards zero.
+  for (int t = 0; t < (int) tracks_.size(); ++t) {
+    if (trackMatched[t]) continue;
+    ++tracks_[t].misses;
+    tracks_[t].box.prob *= 1 - alpha;
+  }
+  tracks_.erase(std::remove_if(tracks_.begin(), tracks_.end(), [&](const Track& track) {
+    return track.misses > options_.maxMisses || (track.misses > 0 && track.box.prob < thresh);
+  }), tracks_.end());
+
+  for (int b = 0; b < (int) boxes->size(); ++b) {
+    if (!boxMatched[b]) tracks_.push_back({(*boxes)[b], 0});
+  }
+
+  boxes->clear();
+  for (const Track& track : tracks_) {
+    boxes->push_back(track.box);
+  }
+}
+
+} /* namespace darknet_ros*/
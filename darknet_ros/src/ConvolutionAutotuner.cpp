@@ -0,0 +1,239 @@
+/*
+ * ConvolutionAutotuner.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "darknet_ros/ConvolutionAutotuner.hpp"
+
+// c++
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+
+// ROS
+#include <ros/console.h>
+
+extern "C" {
+#include "convolutional_layer.h"
+}
+
+namespace darknet_ros {
+
+namespace {
+
+const char *cacheHeader = "# darknet_ros convolution tuning cache: cpu, network, shape, algorithm, tile";
+
+void hashValue(uint64_t *hash, int value)
+{
+  // FNV-1a over the bytes of the value.
+  for (unsigned i = 0; i < sizeof(value); ++i) {
+    *hash ^= (value >> (8 * i)) & 0xff;
+    *hash *= 1099511628211ull;
+  }
+}
+
+std::vector<std::string> splitTabs(const std::string& line)
+{
+  std::vector<std::string> fields;
+  std::stringstream stream(line);
+  std::string field;
+  while (std::getline(stream, field, '\t')) {
+    fields.push_back(field);
+  }
+  return fields;
+}
+
+} /* namespace */
+
+ConvolutionAutotuner::ConvolutionAutotuner(const std::string& cacheFile, int iterations)
+    : cacheFile_(cacheFile),
+      iterations_(std::max(1, iterations))
+{
+}
+
+int ConvolutionAutotuner::tune(network *net)
+{
+  const std::string cpu = cpuModel();
+  const std::string hash = networkHash(net);
+
+  plans_.clear();
+  foreignEntries_.clear();
+  if (loadCache(cpu, hash)) {
+    ROS_INFO("[ConvolutionAutotuner] Loaded %d tuned shapes from %s.", (int) plans_.size(),
+             cacheFile_.c_str());
+  }
+
+  int benchmarked = 0;
+  for (int i = 0; i < net->n; ++i) {
+    const layer& l = net->layers[i];
+    if (l.type != CONVOLUTIONAL) continue;
+
+    const std::string key = shapeKey(l);
+    auto cached = plans_.find(key);
+    if (cached == plans_.end() || !isApplicable(cached->second.algorithm, l)) {
+      plans_[key] = benchmark(net, i);
+      ++benchmarked;
+      ROS_INFO("[ConvolutionAutotuner] Layer %d (%s): %s, tile %d.", i, key.c_str(),
+               algorithmName(plans_[key].algorithm).c_str(), plans_[key].tile);
+    }
+    installConvolutionKernel(net, i, plans_[key]);
+  }
+
+  if (benchmarked > 0 && !saveCache(cpu, hash)) {
+    ROS_WARN("[ConvolutionAutotuner] Could not write tuning cache %s.", cacheFile_.c_str());
+  }
+  return benchmarked;
+}
+
+std::string ConvolutionAutotuner::cpuModel()
+{
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  std::string fallback;
+  while (std::getline(cpuinfo, line)) {
+    const size_t colon = line.find(':');
+    if (colon == std::string::npos) continue;
+    std::string name = line.substr(0, line.find_last_not_of(" \t", colon - 1) + 1);
+    std::string value = line.substr(std::min(line.size(), colon + 2));
+    if (name == "model name") return value;
+    // ARM kernels report the SoC instead of a model name.
+    if (fallback.empty() && (name == "Hardware" || name == "CPU part")) fallback = value;
+  }
+  return fallback.empty() ? "unknown" : fallback;
+}
+
+std::string ConvolutionAutotuner::networkHash(const network *net)
+{
+  uint64_t hash = 14695981039346656037ull;
+  hashValue(&hash, net->w);
+  hashValue(&hash, net->h);
+  hashValue(&hash, net->c);
+  hashValue(&hash, net->batch);
+  for (int i = 0; i < net->n; ++i) {
+    const layer& l = net->layers[i];
+    const int fields[] = {l.type, l.c, l.h, l.w, l.n, l.size, l.stride, l.pad, l.groups,
+                          l.out_c, l.activation, l.batch_normalize, l.xnor};
+    for (int value : fields) {
+      hashValue(&hash, value);
+    }
+  }
+  char text[17];
+  snprintf(text, sizeof(text), "%016llx", (unsigned long long) hash);
+  return text;
+}
+
+std::string ConvolutionAutotuner::shapeKey(const layer& l)
+{
+  std::stringstream key;
+  key << "c" << l.c << "_h" << l.h << "_w" << l.w << "_n" << l.n << "_k" << l.size << "_s" << l.stride
+      << "_p" << l.pad << "_g" << l.groups << "_b" << l.batch;
+  if (l.xnor) key << "_xnor";
+  return key.str();
+}
+
+bool ConvolutionAutotuner::loadCache(const std::string& cpu, const std::string& hash)
+{
+  std::ifstream file(cacheFile_.c_str());
+  if (!file) return false;
+
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    const std::vector<std::string> fields = splitTabs(line);
+    if (fields.size() != 5) continue;
+    if (fields[0] != cpu || fields[1] != hash) {
+      foreignEntries_.push_back(line);
+      continue;
+    }
+    ConvolutionPlan plan;
+    if (!parseAlgorithmName(fields[3], &plan.algorithm)) continue;
+    plan.tile = std::atoi(fields[4].c_str());
+    plans_[fields[2]] = plan;
+  }
+  return true;
+}
+
+bool ConvolutionAutotuner::saveCache(const std::string& cpu, const std::string& hash) const
+{
+  const std::string temporary = cacheFile_ + ".tmp";
+  {
+    std::ofstream file(temporary.c_str());
+    if (!file) return false;
+    file << cacheHeader << "\n";
+    for (const std::string& entry : foreignEntries_) {
+      file << entry << "\n";
+    }
+    for (const auto& entry : plans_) {
+      file << cpu << "\t" << hash << "\t" << entry.first << "\t" << algorithmName(entry.second.algorithm)
+           << "\t" << entry.second.tile << "\n";
+    }
+    if (!file) return false;
+  }
+  return std::rename(temporary.c_str(), cacheFile_.c_str()) == 0;
+}
+
+ConvolutionPlan ConvolutionAutotuner::benchmark(network *net, int index) const
+{
+  const layer& l = net->layers[index];
+  const int outputs = l.outputs * l.batch;
+
+  std::mt19937 generator(index);
+  std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+  std::vector<float> input(l.inputs * l.batch);
+  for (float& value : input) {
+    value = distribution(generator);
+  }
+
+  network scratch = *net;
+  scratch.input = input.data();
+  scratch.train = 0;
+  scratch.index = index;
+
+  // darknet's own result is the reference every candidate has to reproduce.
+  forward_convolutional_layer(l, scratch);
+  const std::vector<float> reference(l.output, l.output + outputs);
+  float magnitude = 1;
+  for (float value : reference) {
+    magnitude = std::max(magnitude, std::fabs(value));
+  }
+
+  ConvolutionPlan best;
+  double bestTime = std::numeric_limits<double>::max();
+  for (const ConvolutionPlan& plan : candidatePlans(l)) {
+    ConvolutionKernel kernel(l, plan);
+    kernel.forward(l, scratch);
+
+    float error = 0;
+    for (int i = 0; i < outputs; ++i) {
+      error = std::max(error, std::fabs(l.output[i] - reference[i]));
+    }
+    if (!(error <= 1e-3f * magnitude)) {
+      ROS_WARN("[ConvolutionAutotuner] Rejected %s (tile %d) for layer %d, error %g.",
+               algorithmName(plan.algorithm).c_str(), plan.tile, index, error);
+      continue;
+    }
+
+    double fastest = std::numeric_limits<double>::max();
+    for (int i = 0; i < iterations_; ++i) {
+      const auto start = std::chrono::steady_clock::now();
+      kernel.forward(l, scratch);
+      const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      fastest = std::min(fastest, elapsed.count());
+    }
+    if (fastest < bestTime) {
+      bestTime = fastest;
+      best = plan;
+    }
+  }
+  return best;
+}
+
+} /* namespace darknet_ros*/
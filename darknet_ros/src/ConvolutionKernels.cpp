@@ -0,0 +1,718 @@
+/*
+ * ConvolutionKernels.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "darknet_ros/ConvolutionKernels.hpp"
+
+// c++
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+
+#include <unistd.h>
+
+#if defined(__AVX2__) || defined(__AVX512VPOPCNTDQ__)
+#include <immintrin.h>
+#endif
+
+// boost
+#include <boost/thread/shared_mutex.hpp>
+
+// darknet_ros
+#include "darknet_ros/TaskScheduler.hpp"
+
+extern "C" {
+#include "activations.h"
+#include "blas.h"
+#include "convolutional_layer.h"
+#include "gemm.h"
+}
+
+namespace darknet_ros {
+
+namespace {
+
+typedef std::vector<std::shared_ptr<ConvolutionKernel> > KernelTable;
+
+//! Installed kernels per network, keyed by its layer array.
+std::map<const layer*, KernelTable> kernelTables;
+boost::shared_mutex kernelTablesMutex;
+
+int ceilDiv(int a, int b)
+{
+  return a >= 0 ? (a + b - 1) / b : -((-a) / b);
+}
+
+//! Unrolled input of the output rows a thread is working on.
+thread_local std::vector<float> tileColumns;
+
+size_t l2CacheBytes()
+{
+  static const size_t bytes = [] {
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    const long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (size > 0) return (size_t) size;
+#endif
+    return (size_t) 512 * 1024;
+  }();
+  return bytes;
+}
+
+/*
+ * im2col_cpu for output rows [firstRow, lastRow) only. Row r of the unrolled matrix is
+ * (channel, kernel y, kernel x) as in darknet, columns are the pixels of the output rows.
+ */
+void im2colRows(const float *im, int channels, int h, int w, int size, int stride, int pad, int outW,
+                int firstRow, int lastRow, float *columns)
+{
+  const int width = (lastRow - firstRow) * outW;
+  for (int r = 0; r < channels * size * size; ++r) {
+    const int kx = r % size;
+    const int ky = (r / size) % size;
+    const float *plane = im + (r / size / size) * h * w;
+    float *out = columns + r * width;
+    for (int y = firstRow; y < lastRow; ++y) {
+      const int iy = y * stride + ky - pad;
+      if (iy < 0 || iy >= h) {
+        std::fill(out, out + outW, 0.f);
+        out += outW;
+        continue;
+      }
+      const float *row = plane + iy * w;
+      for (int x = 0; x < outW; ++x) {
+        const int ix = x * stride + kx - pad;
+        out[x] = (ix < 0 || ix >= w) ? 0 : row[ix];
+      }
+      out += outW;
+    }
+  }
+}
+
+//! Packed input signs of the output pixels a thread is working on, see packColumnSigns().
+thread_local std::vector<uint64_t> tileSigns;
+thread_local std::vector<uint64_t> tileTaps;
+thread_local std::vector<int> tileTapCounts;
+
+/*
+ * Sign bits (x > 0) of the unrolled input for output rows [firstRow, lastRow), words 64-bit
+ * words per output pixel, bit r of a pixel standing for row r of im2col's matrix. With padding,
+ * taps marks the bits that fall inside the image and tapCounts holds their number per pixel.
+ */
+void packColumnSigns(const float *im, const layer& l, int firstRow, int lastRow, int words,
+                     uint64_t *signs, uint64_t *taps, int *tapCounts)
+{
+  const int pixels = (lastRow - firstRow) * l.out_w;
+  std::fill(signs, signs + pixels * words, 0);
+  if (taps) {
+    std::fill(taps, taps + pixels * words, 0);
+    std::fill(tapCounts, tapCounts + pixels, 0);
+  }
+  for (int r = 0; r < l.c * l.size * l.size; ++r) {
+    const int kx = r % l.size;
+    const int ky = (r / l.size) % l.size;
+    const float *plane = im + (r / l.size / l.size) * l.h * l.w;
+    const int word = r / 64;
+    const uint64_t bit = 1ull << (r % 64);
+    for (int y = firstRow; y < lastRow; ++y) {
+      const int iy = y * l.stride + ky - l.pad;
+      if (iy < 0 || iy >= l.h) continue;
+      const float *row = plane + iy * l.w;
+      const int offset = (y - firstRow) * l.out_w;
+      for (int x = 0; x < l.out_w; ++x) {
+        const int ix = x * l.stride + kx - l.pad;
+        if (ix < 0 || ix >= l.w) continue;
+        const int p = offset + x;
+        if (row[ix] > 0) signs[p * words + word] |= bit;
+        if (taps) {
+          taps[p * words + word] |= bit;
+          ++tapCounts[p];
+        }
+      }
+    }
+  }
+}
+
+//! Number of bits set in (a ^ b) & taps, taps only read if masked.
+template<bool masked>
+int countMismatches(const uint64_t *a, const uint64_t *b, const uint64_t *taps, int words)
+{
+  int w = 0;
+  long count = 0;
+#if defined(__AVX512VPOPCNTDQ__)
+  __m512i sum = _mm512_setzero_si512();
+  for (; w + 8 <= words; w += 8) {
+    __m512i x = _mm512_xor_si512(_mm512_loadu_si512(a + w), _mm512_loadu_si512(b + w));
+    if (masked) x = _mm512_and_si512(x, _mm512_loadu_si512(taps + w));
+    sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(x));
+  }
+  count = _mm512_reduce_add_epi64(sum);
+#elif defined(__AVX2__)
+  // Bits per nibble looked up with a byte shuffle, summed per 64-bit lane by sad.
+  const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                          0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+  __m256i sum = _mm256_setzero_si256();
+  for (; w + 4 <= words; w += 4) {
+    __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *) (a + w)),
+                                 _mm256_loadu_si256((const __m256i *) (b + w)));
+    if (masked) x = _mm256_and_si256(x, _mm256_loadu_si256((const __m256i *) (taps + w)));
+    const __m256i bits = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, _mm256_and_si256(x, nibble)),
+                                         _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble)));
+    sum = _mm256_add_epi64(sum, _mm256_sad_epu8(bits, _mm256_setzero_si256()));
+  }
+  count = _mm256_extract_epi64(sum, 0) + _mm256_extract_epi64(sum, 1) + _mm256_extract_epi64(sum, 2)
+      + _mm256_extract_epi64(sum, 3);
+#endif
+  for (; w < words; ++w) {
+    count += __builtin_popcountll((a[w] ^ b[w]) & (masked ? taps[w] : ~0ull));
+  }
+  return static_cast<int>(count);
+}
+
+/*
+ * Sign dot products of filters [firstFilter, lastFilter) with packed columns: taps that agree
+ * count +1, the others -1. Writes them to c, ldc apart per filter.
+ */
+template<bool masked>
+void xnorGemm(int firstFilter, int lastFilter, int columns, int words, int k, const uint64_t *weights,
+              const uint64_t *signs, const uint64_t *taps, const int *tapCounts, float *c, int ldc)
+{
+  for (int f = firstFilter; f < lastFilter; ++f) {
+    const uint64_t *a = weights + f * words;
+    float *out = c + f * ldc;
+    for (int p = 0; p < columns; ++p) {
+      const int valid = masked ? tapCounts[p] : k;
+      out[p] = valid - 2 * countMismatches<masked>(a, signs + p * words, masked ? taps + p * words : nullptr, words);
+    }
+  }
+}
+
+//! C += A * B, the rows of A and C split across the task scheduler.
+void parallelGemm(int m, int n, int k, float *a, int lda, float *b, int ldb, float *c, int ldc)
+{
+  parallelFor(0, m, 8, [=](int first, int last) {
+    gemm(0, 0, last - first, n, k, 1, a + first * lda, lda, b, ldb, 1, c + first * ldc, ldc);
+  });
+}
+
+void forwardInstalledKernel(layer l, network net)
+{
+  ConvolutionKernel *kernel = nullptr;
+  {
+    boost::shared_lock<boost::shared_mutex> lock(kernelTablesMutex);
+    auto table = kernelTables.find(net.layers);
+    if (table != kernelTables.end() && net.index < (int) table->second.size()) {
+      kernel = table->second[net.index].get();
+    }
+  }
+  if (kernel) {
+    kernel->forward(l, net);
+  } else {
+    forward_convolutional_layer(l, net);
+  }
+}
+
+} /* namespace */
+
+std::string algorithmName(ConvolutionAlgorithm algorithm)
+{
+  switch (algorithm) {
+    case ConvolutionAlgorithm::Im2colGemm:
+      return "im2col_gemm";
+    case ConvolutionAlgorithm::Pointwise:
+      return "pointwise";
+    case ConvolutionAlgorithm::Direct:
+      return "direct";
+    case ConvolutionAlgorithm::Winograd:
+      return "winograd";
+    case ConvolutionAlgorithm::Xnor:
+      return "xnor";
+  }
+  return "unknown";
+}
+
+bool parseAlgorithmName(const std::string& name, ConvolutionAlgorithm* algorithm)
+{
+  const ConvolutionAlgorithm all[] = {ConvolutionAlgorithm::Im2colGemm, ConvolutionAlgorithm::Pointwise,
+                                      ConvolutionAlgorithm::Direct, ConvolutionAlgorithm::Winograd,
+                                      ConvolutionAlgorithm::Xnor};
+  for (ConvolutionAlgorithm candidate : all) {
+    if (algorithmName(candidate) == name) {
+      *algorithm = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool isApplicable(ConvolutionAlgorithm algorithm, const layer& l)
+{
+  if (l.type != CONVOLUTIONAL) return false;
+  if (algorithm == ConvolutionAlgorithm::Im2colGemm) return true;
+  if (algorithm == ConvolutionAlgorithm::Xnor) return l.xnor && l.groups == 1;
+  if (l.groups != 1 || l.xnor || l.binary) return false;
+
+  switch (algorithm) {
+    case ConvolutionAlgorithm::Pointwise:
+      return l.size == 1 && l.stride == 1 && l.pad == 0;
+    case ConvolutionAlgorithm::Direct:
+      return true;
+    case ConvolutionAlgorithm::Winograd:
+      return l.size == 3 && l.stride == 1;
+    default:
+      return false;
+  }
+}
+
+std::vector<ConvolutionPlan> candidatePlans(const layer& l)
+{
+  std::vector<ConvolutionPlan> plans;
+  plans.push_back(ConvolutionPlan());
+
+  const int pixels = l.out_h * l.out_w;
+  const int tiles = ((l.out_h + 1) / 2) * ((l.out_w + 1) / 2);
+  const struct {
+    ConvolutionAlgorithm algorithm;
+    int limit;
+    int tiles[3];
+  } families[] = {
+    {ConvolutionAlgorithm::Pointwise, pixels, {1024, 4096, 0}},
+    {ConvolutionAlgorithm::Direct, l.n, {4, 16, 64}},
+    {ConvolutionAlgorithm::Winograd, tiles, {32, 128, 512}},
+    {ConvolutionAlgorithm::Xnor, l.out_h, {0, 2, 8}},
+  };
+
+  for (const auto& family : families) {
+    if (!isApplicable(family.algorithm, l)) continue;
+    int previous = -1;
+    for (int tile : family.tiles) {
+      // Tiles covering the whole dimension are all the same plan.
+      const int effective = (tile <= 0 || tile >= family.limit) ? 0 : tile;
+      if (effective == previous) continue;
+      previous = effective;
+      ConvolutionPlan plan;
+      plan.algorithm = family.algorithm;
+      plan.tile = effective;
+      plans.push_back(plan);
+    }
+  }
+  return plans;
+}
+
+ConvolutionKernel::ConvolutionKernel(const layer& l, const ConvolutionPlan& plan)
+    : plan_(plan),
+      activation_(affineActivationKernel(l.activation))
+{
+  // Batch norm and bias folded into one scale and shift per output channel.
+  outputScale_.assign(l.n, 1.f);
+  outputShift_.assign(l.biases, l.biases + l.n);
+  if (l.batch_normalize) {
+    for (int k = 0; k < l.n; ++k) {
+      outputScale_[k] = l.scales[k] / (std::sqrt(l.rolling_variance[k]) + .000001f);
+      outputShift_[k] -= l.rolling_mean[k] * outputScale_[k];
+    }
+  }
+
+  if (plan_.algorithm == ConvolutionAlgorithm::Xnor) {
+    // darknet's binarize_weights: signs scaled by the mean magnitude of the filter. The scale
+    // goes into the epilogue, the filters keep only their signs.
+    const int k = l.c * l.size * l.size;
+    signWords_ = (k + 63) / 64;
+    signWeights_.assign(l.n * signWords_, 0);
+    for (int f = 0; f < l.n; ++f) {
+      const float *w = l.weights + f * k;
+      float mean = 0;
+      for (int r = 0; r < k; ++r) {
+        mean += std::fabs(w[r]);
+        if (w[r] > 0) signWeights_[f * signWords_ + r / 64] |= 1ull << (r % 64);
+      }
+      outputScale_[f] *= mean / k;
+    }
+    return;
+  }
+
+  if (plan_.algorithm != ConvolutionAlgorithm::Winograd) return;
+
+  // Transform every 3x3 filter once: U = G g G^T, stored as 16 matrices of n x c.
+  const int n = l.n;
+  const int c = l.c;
+  winogradWeights_.resize(16 * n * c);
+  for (int k = 0; k < n; ++k) {
+    for (int ch = 0; ch < c; ++ch) {
+      const float *g = l.weights + (k * c + ch) * 9;
+      float t[4][3];
+      for (int j = 0; j < 3; ++j) {
+        t[0][j] = g[j];
+        t[1][j] = .5f * (g[j] + g[3 + j] + g[6 + j]);
+        t[2][j] = .5f * (g[j] - g[3 + j] + g[6 + j]);
+        t[3][j] = g[6 + j];
+      }
+      for (int i = 0; i < 4; ++i) {
+        const float u[4] = {t[i][0], .5f * (t[i][0] + t[i][1] + t[i][2]),
+                            .5f * (t[i][0] - t[i][1] + t[i][2]), t[i][2]};
+        for (int j = 0; j < 4; ++j) {
+          winogradWeights_[((i * 4 + j) * n + k) * c + ch] = u[j];
+        }
+      }
+    }
+  }
+
+  const int chunk = plan_.tile > 0 ? plan_.tile : ((l.out_h + 1) / 2) * ((l.out_w + 1) / 2);
+  scratch_.resize(16 * (c + n) * chunk);
+}
+
+void ConvolutionKernel::forward(const layer& l, const network& net)
+{
+  switch (plan_.algorithm) {
+    case ConvolutionAlgorithm::Pointwise:
+      forwardPointwise(l, net);
+      break;
+    case ConvolutionAlgorithm::Direct:
+      forwardDirect(l, net);
+      break;
+    case ConvolutionAlgorithm::Winograd:
+      forwardWinograd(l, net);
+      break;
+    case ConvolutionAlgorithm::Xnor:
+      forwardXnor(l, net);
+      break;
+    default:
+      if (l.xnor || l.binary) {
+        forward_convolutional_layer(l, net);
+        return;
+      }
+      forwardIm2colGemm(l, net);
+      break;
+  }
+
+  const int spatial = l.out_h * l.out_w;
+  parallelFor(0, l.batch * l.n, 4, [&](int first, int last) {
+    for (int i = first; i < last; ++i) {
+      const int k = i % l.n;
+      activation_(l.output + i * spatial, spatial, outputScale_[k], outputShift_[k]);
+    }
+  });
+}
+
+void ConvolutionKernel::forwardIm2colGemm(const layer& l, const network& net)
+{
+  // The convolution part of forward_convolutional_layer, without its network-wide workspace:
+  // the input is unrolled for a few output rows at a time, sized so the unrolled tile stays
+  // in L2 until the GEMM has consumed it.
+  const int m = l.n / l.groups;
+  const int k = l.size * l.size * l.c / l.groups;
+  const int n = l.out_w * l.out_h;
+  const int rowsPerTile = plan_.tile > 0 ? plan_.tile
+      : std::max(1, (int) (l2CacheBytes() / 2 / (sizeof(float) * k * l.out_w)));
+  const int tiles = (l.out_h + rowsPerTile - 1) / rowsPerTile;
+
+  fill_cpu(l.outputs * l.batch, 0, l.output, 1);
+  for (int b = 0; b < l.batch; ++b) {
+    for (int g = 0; g < l.groups; ++g) {
+      float *a = l.weights + g * l.nweights / l.groups;
+      float *c = l.output + (b * l.groups + g) * n * m;
+      float *im = net.input + (b * l.groups + g) * l.c / l.groups * l.h * l.w;
+      if (l.size == 1) {
+        parallelGemm(m, n, k, a, k, im, n, c, n);
+        continue;
+      }
+      parallelFor(0, tiles, 1, [&](int first, int last) {
+        for (int t = first; t < last; ++t) {
+          const int firstRow = t * rowsPerTile;
+          const int lastRow = std::min(l.out_h, firstRow + rowsPerTile);
+          const int columns = (lastRow - firstRow) * l.out_w;
+          if (tileColumns.size() < (size_t) k * columns) tileColumns.resize((size_t) k * columns);
+          im2colRows(im, l.c / l.groups, l.h, l.w, l.size, l.stride, l.pad, l.out_w, firstRow, lastRow,
+                     tileColumns.data());
+          float *out = c + firstRow * l.out_w;
+          if (tiles == 1) {
+            parallelGemm(m, columns, k, a, k, tileColumns.data(), columns, out, n);
+          } else {
+            gemm(0, 0, m, columns, k, 1, a, k, tileColumns.data(), columns, 1, out, n);
+          }
+        }
+      });
+    }
+  }
+}
+
+void ConvolutionKernel::forwardPointwise(const layer& l, const network& net)
+{
+  const int m = l.n;
+  const int k = l.c;
+  const int n = l.out_h * l.out_w;
+  const int block = plan_.tile > 0 ? plan_.tile : n;
+
+  fill_cpu(l.outputs * l.batch, 0, l.output, 1);
+  for (int b = 0; b < l.batch; ++b) {
+    float *input = net.input + b * l.inputs;
+    float *output = l.output + b * l.outputs;
+    for (int j = 0; j < n; j += block) {
+      const int columns = std::min(block, n - j);
+      parallelGemm(m, columns, k, l.weights, k, input + j, n, output + j, n);
+    }
+  }
+}
+
+void ConvolutionKernel::forwardDirect(const layer& l, const network& net)
+{
+  const int ow = l.out_w;
+  const int oh = l.out_h;
+  const int size = l.size;
+  const int stride = l.stride;
+  const int pad = l.pad;
+  const int block = plan_.tile > 0 ? plan_.tile : l.n;
+
+  fill_cpu(l.outputs * l.batch, 0, l.output, 1);
+  for (int b = 0; b < l.batch; ++b) {
+    const float *input = net.input + b * l.inputs;
+    float *output = l.output + b * l.outputs;
+
+    // Output channels are shared out across the scheduler. Within a share, a block of output
+    // channels reuses each input plane while it is still in cache.
+    parallelFor(0, l.n, 1, [&](int oBegin, int oEnd) {
+      for (int o0 = oBegin; o0 < oEnd; o0 += block) {
+        const int o1 = std::min(o0 + block, oEnd);
+        for (int ch = 0; ch < l.c; ++ch) {
+          const float *plane = input + ch * l.h * l.w;
+          for (int o = o0; o < o1; ++o) {
+            const float *weights = l.weights + (o * l.c + ch) * size * size;
+            float *out = output + o * oh * ow;
+            for (int kh = 0; kh < size; ++kh) {
+              for (int kw = 0; kw < size; ++kw) {
+                const float weight = weights[kh * size + kw];
+                const int last = l.w - 1 - kw + pad;
+                const int xBegin = std::max(0, ceilDiv(pad - kw, stride));
+                const int xEnd = last < 0 ? 0 : std::min(ow, last / stride + 1);
+                for (int y = 0; y < oh; ++y) {
+                  const int iy = y * stride + kh - pad;
+                  if (iy < 0 || iy >= l.h) continue;
+                  const float *row = plane + iy * l.w;
+                  float *outRow = out + y * ow;
+                  if (stride == 1) {
+                    const int shift = kw - pad;
+                    for (int x = xBegin; x < xEnd; ++x) {
+                      outRow[x] += weight * row[x + shift];
+                    }
+                  } else {
+                    for (int x = xBegin; x < xEnd; ++x) {
+                      outRow[x] += weight * row[x * stride + kw - pad];
+                    }
+                  }
+                }
+              }
+            }
+          }
+        }
+      }
+    });
+  }
+}
+
+void ConvolutionKernel::forwardWinograd(const layer& l, const network& net)
+{
+  const int n = l.n;
+  const int c = l.c;
+  const int ow = l.out_w;
+  const int oh = l.out_h;
+  const int tilesX = (ow + 1) / 2;
+  const int tiles = tilesX * ((oh + 1) / 2);
+  const int chunk = plan_.tile > 0 ? plan_.tile : tiles;
+
+  for (int b = 0; b < l.batch; ++b) {
+    const float *input = net.input + b * l.inputs;
+    float *output = l.output + b * l.outputs;
+
+    for (int p0 = 0; p0 < tiles; p0 += chunk) {
+      const int count = std::min(chunk, tiles - p0);
+      float *v = scratch_.data();
+      float *m = v + 16 * c * count;
+
+      // Input transform V = B^T d B of every 4x4 tile.
+      parallelFor(0, c, 1, [&](int first, int last) {
+        for (int ch = first; ch < last; ++ch) {
+          const float *plane = input + ch * l.h * l.w;
+          for (int q = 0; q < count; ++q) {
+            const int p = p0 + q;
+            const int y0 = 2 * (p / tilesX) - l.pad;
+            const int x0 = 2 * (p % tilesX) - l.pad;
+            float d[4][4];
+            for (int i = 0; i < 4; ++i) {
+              const int y = y0 + i;
+              for (int j = 0; j < 4; ++j) {
+                const int x = x0 + j;
+                d[i][j] = (y < 0 || y >= l.h || x < 0 || x >= l.w) ? 0 : plane[y * l.w + x];
+              }
+            }
+            float t[4][4];
+            for (int j = 0; j < 4; ++j) {
+              t[0][j] = d[0][j] - d[2][j];
+              t[1][j] = d[1][j] + d[2][j];
+              t[2][j] = d[2][j] - d[1][j];
+              t[3][j] = d[1][j] - d[3][j];
+            }
+            for (int i = 0; i < 4; ++i) {
+              const float row[4] = {t[i][0] - t[i][2], t[i][1] + t[i][2], t[i][2] - t[i][1], t[i][1] - t[i][3]};
+              for (int j = 0; j < 4; ++j) {
+                v[((i * 4 + j) * c + ch) * count + q] = row[j];
+              }
+            }
+          }
+        }
+      });
+
+      // One GEMM per transformed element: M = U * V.
+      fill_cpu(16 * n * count, 0, m, 1);
+      parallelFor(0, 16, 1, [&](int first, int last) {
+        for (int e = first; e < last; ++e) {
+          gemm(0, 0, n, count, c, 1, &winogradWeights_[e * n * c], c, v + e * c * count, count, 1,
+               m + e * n * count, count);
+        }
+      });
+
+      // Output transform Y = A^T M A, clipped at the right and bottom border.
+      parallelFor(0, n, 4, [&](int first, int last) {
+        for (int k = first; k < last; ++k) {
+          float *out = output + k * oh * ow;
+          for (int q = 0; q < count; ++q) {
+            const int p = p0 + q;
+            const int y0 = 2 * (p / tilesX);
+            const int x0 = 2 * (p % tilesX);
+            float s[2][4];
+            for (int j = 0; j < 4; ++j) {
+              const float m0 = m[((0 * 4 + j) * n + k) * count + q];
+              const float m1 = m[((1 * 4 + j) * n + k) * count + q];
+              const float m2 = m[((2 * 4 + j) * n + k) * count + q];
+              const float m3 = m[((3 * 4 + j) * n + k) * count + q];
+              s[0][j] = m0 + m1 + m2;
+              s[1][j] = m1 - m2 - m3;
+            }
+            for (int i = 0; i < 2 && y0 + i < oh; ++i) {
+              out[(y0 + i) * ow + x0] = s[i][0] + s[i][1] + s[i][2];
+              if (x0 + 1 < ow) out[(y0 + i) * ow + x0 + 1] = s[i][1] - s[i][2] - s[i][3];
+            }
+          }
+        }
+      });
+    }
+  }
+}
+
+void ConvolutionKernel::forwardXnor(const layer& l, const network& net)
+{
+  // forward_convolutional_layer with xnor: input and weights binarized, then a float GEMM. Here
+  // the signs are packed 64 to a word and multiplied with xor and popcount instead; the per
+  // filter scale is applied by the epilogue.
+  const int words = signWords_;
+  const int k = l.c * l.size * l.size;
+  const int n = l.out_w * l.out_h;
+  const bool masked = l.pad > 0;
+  const size_t rowBytes = (masked ? 2 : 1) * sizeof(uint64_t) * words * l.out_w;
+  const int rowsPerTile = plan_.tile > 0 ? plan_.tile : std::max(1, (int) (l2CacheBytes() / 2 / rowBytes));
+  const int tiles = (l.out_h + rowsPerTile - 1) / rowsPerTile;
+  const uint64_t *weights = signWeights_.data();
+
+  for (int b = 0; b < l.batch; ++b) {
+    const float *im = net.input + b * l.inputs;
+    float *c = l.output + b * l.outputs;
+    parallelFor(0, tiles, 1, [&](int first, int last) {
+      for (int t = first; t < last; ++t) {
+        const int firstRow = t * rowsPerTile;
+        const int lastRow = std::min(l.out_h, firstRow + rowsPerTile);
+        const int columns = (lastRow - firstRow) * l.out_w;
+        if (tileSigns.size() < (size_t) words * columns) tileSigns.resize((size_t) words * columns);
+        if (masked && tileTaps.size() < (size_t) words * columns) tileTaps.resize((size_t) words * columns);
+        if (masked && tileTapCounts.size() < (size_t) columns) tileTapCounts.resize(columns);
+        packColumnSigns(im, l, firstRow, lastRow, words, tileSigns.data(), masked ? tileTaps.data() : nullptr,
+                        tileTapCounts.data());
+        const uint64_t *signs = tileSigns.data();
+        const uint64_t *taps = tileTaps.data();
+        const int *tapCounts = tileTapCounts.data();
+        float *out = c + firstRow * l.out_w;
+        auto multiply = [=](int firstFilter, int lastFilter) {
+          if (masked) {
+            xnorGemm<true>(firstFilter, lastFilter, columns, words, k, weights, signs, taps, tapCounts, out, n);
+          } else {
+            xnorGemm<false>(firstFilter, lastFilter, columns, words, k, weights, signs, taps, tapCounts, out, n);
+          }
+        };
+        if (tiles == 1) {
+          parallelFor(0, l.n, 8, multiply);
+        } else {
+          multiply(0, l.n);
+        }
+      }
+    });
+  }
+}
+
+void installConvolutionKernel(network *net, int index, const ConvolutionPlan& plan)
+{
+  layer& l = net->layers[index];
+  if (!isApplicable(plan.algorithm, l)) return;
+
+  boost::unique_lock<boost::shared_mutex> lock(kernelTablesMutex);
+  KernelTable& table = kernelTables[net->layers];
+  table.resize(net->n);
+  table[index] = std::make_shared<ConvolutionKernel>(l, plan);
+  l.forward = forwardInstalledKernel;
+}
+
+int installDefaultConvolutionKernels(network *net)
+{
+  int installed = 0;
+  for (int i = 0; i < net->n; ++i) {
+    if (net->layers[i].type != CONVOLUTIONAL || net->layers[i].forward != forward_convolutional_layer) continue;
+    ConvolutionPlan plan;
+    if (isApplicable(ConvolutionAlgorithm::Xnor, net->layers[i])) plan.algorithm = ConvolutionAlgorithm::Xnor;
+    installConvolutionKernel(net, i, plan);
+    ++installed;
+  }
+  return installed;
+}
+
+size_t shrinkWorkspace(network *net)
+{
+  size_t needed = 0;
+  {
+    boost::shared_lock<boost::shared_mutex> lock(kernelTablesMutex);
+    auto table = kernelTables.find(net->layers);
+    for (int i = 0; i < net->n; ++i) {
+      const layer& l = net->layers[i];
+      const ConvolutionKernel *kernel = nullptr;
+      if (l.forward == forwardInstalledKernel && table != kernelTables.end() && i < (int) table->second.size()) {
+        kernel = table->second[i].get();
+      }
+      // Installed kernels bring their own buffers, unless they fall back to darknet.
+      const bool ownBuffers = kernel && (kernel->plan().algorithm == ConvolutionAlgorithm::Xnor
+          || (!l.xnor && !l.binary));
+      if (!ownBuffers) needed = std::max(needed, l.workspace_size);
+    }
+  }
+
+  size_t allocated = 0;
+  for (int i = 0; i < net->n; ++i) {
+    allocated = std::max(allocated, net->layers[i].workspace_size);
+  }
+  if (needed >= allocated || !net->workspace) return 0;
+
+  free(net->workspace);
+  net->workspace = needed > 0 ? (float *) calloc(1, needed) : nullptr;
+  return allocated - needed;
+}
+
+void clearConvolutionKernels(network *net)
+{
+  boost::unique_lock<boost::shared_mutex> lock(kernelTablesMutex);
+  kernelTables.erase(net->layers);
+  for (int i = 0; i < net->n; ++i) {
+    if (net->layers[i].forward == forwardInstalledKernel) {
+      net->layers[i].forward = forward_convolutional_layer;
+    }
+  }
+}
+
+} /* namespace darknet_ros*/
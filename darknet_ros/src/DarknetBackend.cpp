@@ -0,0 +1,98 @@
+/*
+ * DarknetBackend.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "darknet_ros/DarknetBackend.hpp"
+
+// ROS
+#include <ros/console.h>
+
+// darknet_ros
+#include "darknet_ros/Activations.hpp"
+#include "darknet_ros/ConvolutionAutotuner.hpp"
+#include "darknet_ros/ConvolutionKernels.hpp"
+#include "darknet_ros/NetworkPasses.hpp"
+
+extern "C" {
+#include "parser.h"
+}
+
+namespace darknet_ros {
+
+DarknetBackend::DarknetBackend(const Options& options)
+    : options_(options)
+{
+}
+
+bool DarknetBackend::load(const std::string& config, const std::string& model)
+{
+  net_ = load_network(const_cast<char *>(config.c_str()), const_cast<char *>(model.c_str()), 0);
+  if (!net_) return false;
+  set_batch_network(net_, 1);
+
+  // Resized before any rewrite, which assume fixed layer sizes.
+  const int width = options_.inputWidth > 0 ? options_.inputWidth : net_->w;
+  const int height = options_.inputHeight > 0 ? options_.inputHeight : net_->h;
+  if (width != net_->w || height != net_->h) {
+    ROS_INFO("[YoloObjectDetector] Network input resized from %dx%d to %dx%d.", net_->w, net_->h, width, height);
+    resize_network(net_, width, height);
+  }
+
+  if (!options_.detectionHeads.empty()) {
+    int removed = pruneDetectionHeads(net_, options_.detectionHeads);
+    if (removed < 0) {
+      ROS_WARN("[YoloObjectDetector] None of the configured detection heads exists, keeping all.");
+    } else {
+      ROS_INFO("[YoloObjectDetector] %d layers of unused detection heads removed.", removed);
+    }
+  }
+
+#ifdef GPU
+  if (options_.autotune || options_.pruneZeroChannels) {
+    ROS_WARN("[YoloObjectDetector] Channel pruning and autotuning only apply to CPU builds.");
+  }
+#else
+  if (options_.pruneZeroChannels) {
+    int removed = pruneZeroChannels(net_);
+    ROS_INFO("[YoloObjectDetector] %d zero convolution channels removed.", removed);
+  }
+  if (options_.fuseRoutes) {
+    int fused = fuseRouteConcatenations(net_);
+    ROS_INFO("[YoloObjectDetector] %d route layers turned into views.", fused);
+  }
+  if (options_.autotune) {
+    ConvolutionAutotuner autotuner(options_.tuningCacheFile, options_.tuningIterations);
+    int benchmarked = autotuner.tune(net_);
+    ROS_INFO("[YoloObjectDetector] Convolutions tuned, %d new layer shapes benchmarked.", benchmarked);
+  }
+  // Tuned or not, every convolution runs a tiled kernel, so the workspace shrinks below.
+  int kernels = installDefaultConvolutionKernels(net_);
+  ROS_INFO("[YoloObjectDetector] %d convolutions switched to tiled kernels.", kernels);
+  if (options_.vectorizedActivations) {
+    int installed = installVectorizedActivations(net_);
+    ROS_INFO("[YoloObjectDetector] %d layers switched to vectorized activations.", installed);
+  }
+  const size_t released = shrinkWorkspace(net_);
+  if (released > 0) {
+    ROS_INFO("[YoloObjectDetector] Convolution workspace reduced by %.1f MB.", released / 1048576.);
+  }
+#endif
+
+  heads_ = detectionHeads(net_);
+  return true;
+}
+
+void DarknetBackend::run(float *input)
+{
+  network_predict(net_, input);
+}
+
+detection *DarknetBackend::detections(const std::vector<int>& heads, int width, int height, float thresh,
+                                      float hier, int *count)
+{
+  return headDetections(net_, heads, width, height, thresh, hier, count);
+}
+
+} /* namespace darknet_ros*/
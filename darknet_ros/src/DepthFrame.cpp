@@ -0,0 +1,62 @@
+/*
+ * DepthFrame.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "darknet_ros/DepthFrame.hpp"
+
+// c++
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace darknet_ros {
+
+namespace {
+
+bool isHostBigEndian()
+{
+  const unsigned short probe = 1;
+  return *reinterpret_cast<const unsigned char *>(&probe) == 0;
+}
+
+} /* namespace */
+
+bool DepthFrame::parseEncoding(const std::string& encoding, Encoding* result)
+{
+  if (encoding == "16UC1" || encoding == "mono16") {
+    *result = Millimetres16U;
+    return true;
+  }
+  if (encoding == "32FC1") {
+    *result = Metres32F;
+    return true;
+  }
+  return false;
+}
+
+float DepthFrame::metres(int x, int y) const
+{
+  if (!data || x < 0 || y < 0 || x >= width || y >= height) return NAN;
+
+  const unsigned char *pixel = data + y * step;
+  if (encoding == Millimetres16U) {
+    pixel += 2 * x;
+    const unsigned value = bigEndian ? (pixel[0] << 8 | pixel[1]) : (pixel[1] << 8 | pixel[0]);
+    // Zero marks a missing measurement.
+    return value == 0 ? NAN : value * .001f;
+  }
+
+  unsigned char bytes[4];
+  std::memcpy(bytes, pixel + 4 * x, 4);
+  if (bigEndian != isHostBigEndian()) {
+    std::swap(bytes[0], bytes[3]);
+    std::swap(bytes[1], bytes[2]);
+  }
+  float value;
+  std::memcpy(&value, bytes, 4);
+  return value;
+}
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,52 @@
+/*
+ * DetectionBoxes.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "darknet_ros/DetectionBoxes.hpp"
+
+// c++
+#include <algorithm>
+
+extern "C" {
+#include "box.h"
+}
+
+namespace darknet_ros {
+
+std::vector<int> mainDetectionHeads(const std::vector<DetectionHead>& heads, const std::vector<bool>& taken)
+{
+  std::vector<int> main;
+  for (int i = 0; i < (int) heads.size(); ++i) {
+    if (taken[i]) continue;
+    if (!main.empty() && heads[i].classes != heads[main.front()].classes) continue;
+    main.push_back(i);
+  }
+  return main;
+}
+
+void suppressDetections(detection *dets, int count, int classes, float overlap)
+{
+  if (overlap > 0) do_nms_obj(dets, count, classes, overlap);
+}
+
+void collectFrameBoxes(const detection *dets, int count, int classes, std::vector<FrameBox> *boxes)
+{
+  boxes->clear();
+  for (int i = 0; i < count; ++i) {
+    const box& b = dets[i].bbox;
+    const float xmin = std::max(0.f, b.x - b.w / 2);
+    const float xmax = std::min(1.f, b.x + b.w / 2);
+    const float ymin = std::max(0.f, b.y - b.h / 2);
+    const float ymax = std::min(1.f, b.y + b.h / 2);
+    if (xmax - xmin <= MinimumBoxSize || ymax - ymin <= MinimumBoxSize) continue;
+
+    for (int j = 0; j < classes; ++j) {
+      if (!dets[i].prob[j]) continue;
+      boxes->push_back({j, dets[i].prob[j], xmin, ymin, xmax, ymax});
+    }
+  }
+}
+
+} /* namespace darknet_ros*/
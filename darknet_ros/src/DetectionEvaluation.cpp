@@ -0,0 +1,133 @@
+/*
+ * DetectionEvaluation.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "darknet_ros/DetectionEvaluation.hpp"
+
+// c++
+#include <algorithm>
+#include <fstream>
+
+namespace darknet_ros {
+
+namespace {
+
+float overlap(const EvaluatedBox& a, const EvaluatedBox& b)
+{
+  const float w = std::min(a.xmax, b.xmax) - std::max(a.xmin, b.xmin);
+  const float h = std::min(a.ymax, b.ymax) - std::max(a.ymin, b.ymin);
+  if (w <= 0 || h <= 0) return 0;
+  const float intersection = w * h;
+  const float united = (a.xmax - a.xmin) * (a.ymax - a.ymin) + (b.xmax - b.xmin) * (b.ymax - b.ymin) - intersection;
+  return intersection / united;
+}
+
+} /* namespace */
+
+void readDarknetLabels(const std::string& image, const std::string& directory, int index,
+                       std::vector<EvaluatedBox> *labels)
+{
+  std::string file = image.substr(0, image.rfind('.')) + ".txt";
+  if (!directory.empty()) file = directory + "/" + file.substr(file.rfind('/') + 1);
+  std::ifstream stream(file.c_str());
+  int classId;
+  float x, y, w, h;
+  while (stream >> classId >> x >> y >> w >> h) {
+    labels->push_back({index, classId, 1.f, x - w / 2, y - h / 2, x + w / 2, y + h / 2});
+  }
+}
+
+DetectionEvaluation evaluateDetections(const std::vector<EvaluatedBox>& labels,
+                                       const std::vector<EvaluatedBox>& detections, int images, int classes,
+                                       float threshold, float iou)
+{
+  DetectionEvaluation evaluation;
+  evaluation.classAp.assign(classes, 0);
+  evaluation.classRecall.assign(classes, 0);
+  int labelled = 0;
+  int evaluated = 0;
+  int truePositives = 0;
+  int positives = 0;
+  for (int c = 0; c < classes; ++c) {
+    std::vector<std::vector<const EvaluatedBox *> > truth(images);
+    int count = 0;
+    for (const EvaluatedBox& label : labels) {
+      if (label.classId != c) continue;
+      truth[label.image].push_back(&label);
+      ++count;
+    }
+    std::vector<const EvaluatedBox *> found;
+    for (const EvaluatedBox& detection : detections) {
+      if (detection.classId == c && detection.probability >= threshold) found.push_back(&detection);
+    }
+    std::stable_sort(found.begin(), found.end(),
+                     [](const EvaluatedBox *a, const EvaluatedBox *b) { return a->probability > b->probability; });
+
+    std::vector<std::vector<bool> > matched(images);
+    for (int i = 0; i < images; ++i) {
+      matched[i].assign(truth[i].size(), false);
+    }
+    std::vector<double> precision;
+    std::vector<double> recall;
+    int hits = 0;
+    for (size_t k = 0; k < found.size(); ++k) {
+      const EvaluatedBox& detection = *found[k];
+      int best = -1;
+      float bestOverlap = iou;
+      for (size_t j = 0; j < truth[detection.image].size(); ++j) {
+        const float o = overlap(detection, *truth[detection.image][j]);
+        if (o >= bestOverlap && !matched[detection.image][j]) {
+          best = j;
+          bestOverlap = o;
+        }
+      }
+      if (best >= 0) {
+        matched[detection.image][best] = true;
+        ++hits;
+      }
+      precision.push_back(hits / double(k + 1));
+      recall.push_back(count ? hits / double(count) : 0);
+    }
+    truePositives += hits;
+    positives += found.size();
+    if (!count) continue;
+
+    for (int k = (int) precision.size() - 2; k >= 0; --k) {
+      precision[k] = std::max(precision[k], precision[k + 1]);
+    }
+    double ap = 0;
+    double previous = 0;
+    for (size_t k = 0; k < precision.size(); ++k) {
+      ap += (recall[k] - previous) * precision[k];
+      previous = recall[k];
+    }
+    evaluation.classAp[c] = ap;
+    evaluation.classRecall[c] = hits / double(count);
+    evaluation.map += ap;
+    labelled += count;
+    ++evaluated;
+  }
+  if (evaluated) evaluation.map /= evaluated;
+  evaluation.precision = positives ? truePositives / double(positives) : 0;
+  evaluation.recall = labelled ? truePositives / double(labelled) : 0;
+  return evaluation;
+}
+
+void markPareto(std::vector<OperatingPoint> *points)
+{
+  for (OperatingPoint& p : *points) {
+    p.pareto = true;
+    for (const OperatingPoint& q : *points) {
+      const bool asGood = q.latency <= p.latency && q.memory <= p.memory && q.map >= p.map;
+      const bool better = q.latency < p.latency || q.memory < p.memory || q.map > p.map;
+      if (asGood && better) {
+        p.pareto = false;
+        break;
+      }
+    }
+  }
+}
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,40 @@
+/*
+ * DetectionViewer.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "darknet_ros/DetectionViewer.hpp"
+
+#ifndef DARKNET_ROS_HEADLESS
+#include "darknet_ros/HighGuiViewer.hpp"
+
+// Check for xServer
+#include <X11/Xlib.h>
+#endif
+
+namespace darknet_ros {
+
+bool DetectionViewer::displayAvailable()
+{
+#ifdef DARKNET_ROS_HEADLESS
+  return false;
+#else
+  Display *display = XOpenDisplay(NULL);
+  if (!display) return false;
+  XCloseDisplay(display);
+  return true;
+#endif
+}
+
+std::unique_ptr<DetectionViewer> DetectionViewer::create(const Options& options,
+                                                         const std::function<void(int key)>& onKey)
+{
+#ifdef DARKNET_ROS_HEADLESS
+  return std::unique_ptr<DetectionViewer>();
+#else
+  return std::unique_ptr<DetectionViewer>(new HighGuiViewer(options, onKey));
+#endif
+}
+
+} /* namespace darknet_ros*/
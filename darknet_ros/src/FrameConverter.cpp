@@ -0,0 +1,301 @@
+/*
+ * FrameConverter.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "darknet_ros/FrameConverter.hpp"
+
+// c++
+#include <algorithm>
+#include <vector>
+
+// darknet_ros
+#include "darknet_ros/TaskScheduler.hpp"
+
+namespace darknet_ros {
+
+namespace {
+
+inline float clampByte(float value)
+{
+  return std::min(255.f, std::max(0.f, value));
+}
+
+//! Limited range BT.601, as OpenCV's YUV to BGR conversions.
+inline void yuvToRgb(int y, int u, int v, float *rgb)
+{
+  const float luma = 1.164f * (y - 16);
+  rgb[0] = clampByte(luma + 1.596f * (v - 128)) / 255.f;
+  rgb[1] = clampByte(luma - 0.813f * (v - 128) - 0.391f * (u - 128)) / 255.f;
+  rgb[2] = clampByte(luma + 2.018f * (u - 128)) / 255.f;
+}
+
+// Readers return the RGB value of one source pixel.
+
+template <int R, int G, int B, int Channels>
+struct PackedReader
+{
+  const CameraFrame& frame;
+  void operator()(int x, int y, float *rgb) const
+  {
+    const unsigned char *pixel = frame.data + y * frame.step + x * Channels;
+    rgb[0] = pixel[R] / 255.f;
+    rgb[1] = pixel[G] / 255.f;
+    rgb[2] = pixel[B] / 255.f;
+  }
+};
+
+struct Mono8Reader
+{
+  const CameraFrame& frame;
+  void operator()(int x, int y, float *rgb) const
+  {
+    rgb[0] = rgb[1] = rgb[2] = frame.data[y * frame.step + x] / 255.f;
+  }
+};
+
+struct Mono16Reader
+{
+  const CameraFrame& frame;
+  void operator()(int x, int y, float *rgb) const
+  {
+    const unsigned char *pixel = frame.data + y * frame.step + 2 * x;
+    const int value = frame.bigEndian ? (pixel[0] << 8 | pixel[1]) : (pixel[1] << 8 | pixel[0]);
+    rgb[0] = rgb[1] = rgb[2] = value / 65535.f;
+  }
+};
+
+//! Packed 4:2:2, two pixels share one U and one V sample.
+template <int Y, int U, int V>
+struct Yuv422Reader
+{
+  const CameraFrame& frame;
+  void operator()(int x, int y, float *rgb) const
+  {
+    const unsigned char *pair = frame.data + y * frame.step + (x >> 1) * 4;
+    yuvToRgb(pair[Y + 2 * (x & 1)], pair[U], pair[V], rgb);
+  }
+};
+
+//! Luma plane followed by interleaved chroma at half resolution in both directions.
+template <int U, int V>
+struct Yuv420spReader
+{
+  const CameraFrame& frame;
+  void operator()(int x, int y, float *rgb) const
+  {
+    const unsigned char *chroma = frame.data + (frame.height + (y >> 1)) * frame.step + (x & ~1);
+    yuvToRgb(frame.data[y * frame.step + x], chroma[U], chroma[V], rgb);
+  }
+};
+
+/*
+ * Bayer mosaic, demosaiced per 2x2 cell: red, blue and the mean of both greens of the cell
+ * the pixel lies in. R and B are the positions of red and blue in the cell (row major).
+ */
+template <int R, int B>
+struct BayerReader
+{
+  const CameraFrame& frame;
+  void operator()(int x, int y, float *rgb) const
+  {
+    const int x0 = std::min(x & ~1, frame.width - 2);
+    const int y0 = std::min(y & ~1, frame.height - 2);
+    const unsigned char *top = frame.data + y0 * frame.step + x0;
+    const unsigned char cell[4] = {top[0], top[1], top[frame.step], top[frame.step + 1]};
+    rgb[0] = cell[R] / 255.f;
+    rgb[1] = (cell[0] + cell[1] + cell[2] + cell[3] - cell[R] - cell[B]) / 510.f;
+    rgb[2] = cell[B] / 255.f;
+  }
+};
+
+/*
+ * darknet's resize_image (horizontal pass, then vertical pass) with the conversion folded in.
+ * Horizontally interpolated source rows are kept while consecutive output rows reuse them.
+ */
+template <typename Reader>
+void resizeInto(const Reader& read, int sourceWidth, int sourceHeight, image out, int width, int height,
+                int dx, int dy)
+{
+  const float widthScale = (float) (sourceWidth - 1) / (width - 1);
+  const float heightScale = (float) (sourceHeight - 1) / (height - 1);
+
+  std::vector<int> columns(width);
+  std::vector<float> weights(width);
+  for (int c = 0; c < width; ++c) {
+    if (c == width - 1 || sourceWidth == 1) {
+      columns[c] = -1;
+      continue;
+    }
+    const float sx = c == 0 ? 0 : c * widthScale;
+    columns[c] = (int) sx;
+    weights[c] = sx - columns[c];
+  }
+
+  // Bands of output rows are converted in parallel, each with its own pair of cached rows.
+  parallelFor(0, height, 16, [&](int rowBegin, int rowEnd) {
+    std::vector<float> rows[2] = {std::vector<float>(3 * width), std::vector<float>(3 * width)};
+    int rowIndex[2] = {-1, -1};
+    auto interpolateRow = [&](int sy, std::vector<float> *row) {
+      float left[3];
+      float right[3];
+      for (int c = 0; c < width; ++c) {
+        if (columns[c] < 0) {
+          read(sourceWidth - 1, sy, left);
+          for (int k = 0; k < 3; ++k) {
+            (*row)[k * width + c] = left[k];
+          }
+          continue;
+        }
+        read(columns[c], sy, left);
+        read(columns[c] + 1, sy, right);
+        for (int k = 0; k < 3; ++k) {
+          (*row)[k * width + c] = (1 - weights[c]) * left[k] + weights[c] * right[k];
+        }
+      }
+    };
+
+    const int plane = out.w * out.h;
+    for (int r = rowBegin; r < rowEnd; ++r) {
+      const float sy = r == 0 ? 0 : r * heightScale;
+      const int iy = (int) sy;
+      const float weight = sy - iy;
+      const bool lastRow = r == height - 1 || sourceHeight == 1;
+
+      // Slot 0 holds source row iy, slot 1 row iy + 1.
+      if (rowIndex[0] != iy) {
+        if (rowIndex[1] == iy) {
+          std::swap(rows[0], rows[1]);
+          std::swap(rowIndex[0], rowIndex[1]);
+        } else {
+          interpolateRow(iy, &rows[0]);
+          rowIndex[0] = iy;
+        }
+      }
+      if (!lastRow && rowIndex[1] != iy + 1) {
+        interpolateRow(iy + 1, &rows[1]);
+        rowIndex[1] = iy + 1;
+      }
+
+      for (int k = 0; k < 3; ++k) {
+        float *target = out.data + k * plane + (dy + r) * out.w + dx;
+        const float *top = rows[0].data() + k * width;
+        const float *bottom = rows[1].data() + k * width;
+        if (lastRow) {
+          for (int c = 0; c < width; ++c) {
+            target[c] = (1 - weight) * top[c];
+          }
+        } else {
+          for (int c = 0; c < width; ++c) {
+            target[c] = (1 - weight) * top[c] + weight * bottom[c];
+          }
+        }
+      }
+    }
+  });
+}
+
+} /* namespace */
+
+bool parsePixelFormat(const std::string& encoding, PixelFormat* format)
+{
+  const struct {
+    const char *name;
+    PixelFormat format;
+  } formats[] = {
+    {"bgr8", PixelFormat::BGR8}, {"rgb8", PixelFormat::RGB8}, {"bgra8", PixelFormat::BGRA8},
+    {"rgba8", PixelFormat::RGBA8}, {"mono8", PixelFormat::MONO8}, {"8UC1", PixelFormat::MONO8},
+    {"mono16", PixelFormat::MONO16}, {"16UC1", PixelFormat::MONO16}, {"yuv422", PixelFormat::UYVY},
+    {"uyvy", PixelFormat::UYVY}, {"yuv422_yuy2", PixelFormat::YUYV}, {"yuyv", PixelFormat::YUYV},
+    {"nv12", PixelFormat::NV12}, {"nv21", PixelFormat::NV21}, {"bayer_rggb8", PixelFormat::BayerRGGB8},
+    {"bayer_bggr8", PixelFormat::BayerBGGR8}, {"bayer_gbrg8", PixelFormat::BayerGBRG8},
+    {"bayer_grbg8", PixelFormat::BayerGRBG8},
+  };
+  for (const auto& entry : formats) {
+    if (encoding == entry.name) {
+      *format = entry.format;
+      return true;
+    }
+  }
+  return false;
+}
+
+void convertFrame(const CameraFrame& frame, image out, int width, int height, int dx, int dy)
+{
+  const int w = frame.width;
+  const int h = frame.height;
+  switch (frame.format) {
+    case PixelFormat::BGR8:
+      resizeInto(PackedReader<2, 1, 0, 3>{frame}, w, h, out, width, height, dx, dy);
+      break;
+    case PixelFormat::RGB8:
+      resizeInto(PackedReader<0, 1, 2, 3>{frame}, w, h, out, width, height, dx, dy);
+      break;
+    case PixelFormat::BGRA8:
+      resizeInto(PackedReader<2, 1, 0, 4>{frame}, w, h, out, width, height, dx, dy);
+      break;
+    case PixelFormat::RGBA8:
+      resizeInto(PackedReader<0, 1, 2, 4>{frame}, w, h, out, width, height, dx, dy);
+      break;
+    case PixelFormat::MONO8:
+      resizeInto(Mono8Reader{frame}, w, h, out, width, height, dx, dy);
+      break;
+    case PixelFormat::MONO16:
+      resizeInto(Mono16Reader{frame}, w, h, out, width, height, dx, dy);
+      break;
+    case PixelFormat::UYVY:
+      resizeInto(Yuv422Reader<1, 0, 2>{frame}, w, h, out, width, height, dx, dy);
+      break;
+    case PixelFormat::YUYV:
+      resizeInto(Yuv422Reader<0, 1, 3>{frame}, w, h, out, width, height, dx, dy);
+      break;
+    case PixelFormat::NV12:
+      resizeInto(Yuv420spReader<0, 1>{frame}, w, h, out, width, height, dx, dy);
+      break;
+    case PixelFormat::NV21:
+      resizeInto(Yuv420spReader<1, 0>{frame}, w, h, out, width, height, dx, dy);
+      break;
+    case PixelFormat::BayerRGGB8:
+      resizeInto(BayerReader<0, 3>{frame}, w, h, out, width, height, dx, dy);
+      break;
+    case PixelFormat::BayerBGGR8:
+      resizeInto(BayerReader<3, 0>{frame}, w, h, out, width, height, dx, dy);
+      break;
+    case PixelFormat::BayerGBRG8:
+      resizeInto(BayerReader<2, 1>{frame}, w, h, out, width, height, dx, dy);
+      break;
+    case PixelFormat::BayerGRBG8:
+      resizeInto(BayerReader<1, 2>{frame}, w, h, out, width, height, dx, dy);
+      break;
+  }
+}
+
+void letterboxFrame(const CameraFrame& frame, image boxed)
+{
+  // Same geometry as letterbox_image_into.
+  int width = frame.width;
+  int height = frame.height;
+  if (((float) boxed.w / frame.width) < ((float) boxed.h / frame.height)) {
+    width = boxed.w;
+    height = (frame.height * boxed.w) / frame.width;
+  } else {
+    height = boxed.h;
+    width = (frame.width * boxed.h) / frame.height;
+  }
+  const int dx = (boxed.w - width) / 2;
+  const int dy = (boxed.h - height) / 2;
+
+  for (int k = 0; k < boxed.c; ++k) {
+    float *plane = boxed.data + k * boxed.w * boxed.h;
+    std::fill(plane, plane + dy * boxed.w, .5f);
+    std::fill(plane + (dy + height) * boxed.w, plane + boxed.h * boxed.w, .5f);
+    for (int y = dy; y < dy + height; ++y) {
+      std::fill(plane + y * boxed.w, plane + y * boxed.w + dx, .5f);
+      std::fill(plane + y * boxed.w + dx + width, plane + (y + 1) * boxed.w, .5f);
+    }
+  }
+  convertFrame(frame, boxed, width, height, dx, dy);
+}
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,93 @@
+/*
+ * FrameScheduler.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "darknet_ros/FrameScheduler.hpp"
+
+// c++
+#include <algorithm>
+
+namespace darknet_ros {
+
+void FrameScheduler::setPolicy(FrameClass frameClass, const Policy& policy)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  Queue& target = queue(frameClass);
+  target.policy = policy;
+  target.policy.capacity = std::max<size_t>(1, policy.capacity);
+  while (target.frames.size() > target.policy.capacity) {
+    target.frames.pop_front();
+    ++target.statistics.dropped;
+  }
+}
+
+bool FrameScheduler::push(const ScheduledFrame& frame)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Queue& target = queue(frame.frameClass);
+    if (target.frames.size() >= target.policy.capacity) {
+      ++target.statistics.dropped;
+      if (!target.policy.dropOldest) return false;
+      target.frames.pop_front();
+    }
+    target.frames.push_back(frame);
+    target.frames.back().queued = Clock::now();
+  }
+  condition_.notify_one();
+  return true;
+}
+
+bool FrameScheduler::pop(ScheduledFrame *frame, std::chrono::milliseconds timeout)
+{
+  const Clock::time_point deadline = Clock::now() + timeout;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    const Clock::time_point now = Clock::now();
+    Clock::time_point wakeup = deadline;
+    for (Queue& candidate : queues_) {
+      if (candidate.frames.empty()) continue;
+      if (candidate.nextDispatch > now) {
+        // Rate limited, lower classes may run until it is due.
+        wakeup = std::min(wakeup, candidate.nextDispatch);
+        continue;
+      }
+      *frame = candidate.frames.front();
+      candidate.frames.pop_front();
+      if (candidate.policy.maxRate > 0) {
+        candidate.nextDispatch = now + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1. / candidate.policy.maxRate));
+      }
+
+      Statistics& statistics = candidate.statistics;
+      const double delay = std::chrono::duration<double>(now - frame->queued).count();
+      ++statistics.dispatched;
+      statistics.meanDelay += (delay - statistics.meanDelay) / statistics.dispatched;
+      statistics.maxDelay = std::max(statistics.maxDelay, delay);
+      return true;
+    }
+    if (now >= deadline) return false;
+    condition_.wait_until(lock, wakeup);
+  }
+}
+
+size_t FrameScheduler::clear(FrameClass frameClass)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  Queue& target = queue(frameClass);
+  const size_t cleared = target.frames.size();
+  target.frames.clear();
+  return cleared;
+}
+
+FrameScheduler::Statistics FrameScheduler::collectStatistics(FrameClass frameClass)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  Statistics collected = queue(frameClass).statistics;
+  queue(frameClass).statistics = Statistics();
+  return collected;
+}
+
+} /* namespace darknet_ros*/
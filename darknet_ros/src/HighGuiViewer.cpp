@@ -0,0 +1,95 @@
+/*
+ * HighGuiViewer.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "darknet_ros/HighGuiViewer.hpp"
+
+// c++
+#include <algorithm>
+#include <chrono>
+
+// POSIX
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// OpenCV
+#include <opencv2/highgui/highgui.hpp>
+
+namespace darknet_ros {
+
+HighGuiViewer::HighGuiViewer(const Options& options, const std::function<void(int key)>& onKey)
+    : options_(options),
+      onKey_(onKey)
+{
+  thread_ = std::thread(&HighGuiViewer::run, this);
+}
+
+HighGuiViewer::~HighGuiViewer()
+{
+  running_ = false;
+  thread_.join();
+}
+
+void HighGuiViewer::show(const cv::Mat& frame)
+{
+  if (!waiting_.exchange(false)) return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Same size as the frame it was swapped with, so no allocation.
+  frame.copyTo(pending_);
+  fresh_ = true;
+}
+
+void HighGuiViewer::run()
+{
+#ifdef __linux__
+  // Niceness is per thread on Linux: the window yields to inference and publishing.
+  setpriority(PRIO_PROCESS, syscall(SYS_gettid), 10);
+#endif
+
+  // All GUI calls stay on this thread.
+  const char *window = options_.window.c_str();
+  cvNamedWindow(window, CV_WINDOW_NORMAL);
+  if (options_.fullScreen) {
+    cvSetWindowProperty(window, CV_WND_PROP_FULLSCREEN, CV_WINDOW_FULLSCREEN);
+  } else {
+    cvMoveWindow(window, 0, 0);
+    cvResizeWindow(window, 640, 480);
+  }
+
+  const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(1. / std::max(options_.rate, 1e-3)));
+  auto next = std::chrono::steady_clock::now();
+  cv::Mat shown;
+  while (running_) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (fresh_) {
+        cv::swap(shown, pending_);
+        fresh_ = false;
+      }
+    }
+    waiting_ = true;
+    if (!shown.empty()) {
+      cv::imshow(options_.window, shown);
+    }
+
+    int key = cvWaitKey(std::max(1, options_.waitKeyDelay));
+    if (key != -1) onKey_(key % 256);
+
+    next += period;
+    const auto now = std::chrono::steady_clock::now();
+    if (next > now) {
+      std::this_thread::sleep_for(next - now);
+    } else {
+      next = now;
+    }
+  }
+  cvDestroyWindow(window);
+}
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,97 @@
+/*
+ * InferenceBackend.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "darknet_ros/InferenceBackend.hpp"
+
+// c++
+#include <cstdlib>
+
+// darknet_ros
+#include "darknet_ros/NetworkPasses.hpp"
+
+extern "C" {
+#include "detection_layer.h"
+#include "region_layer.h"
+#include "yolo_layer.h"
+}
+
+namespace darknet_ros {
+
+namespace {
+
+//! Layer indices of the listed detection heads.
+std::vector<int> headLayers(network *net, const std::vector<int>& heads)
+{
+  std::vector<int> all;
+  for (int i = 0; i < net->n; ++i) {
+    if (isDetectionLayer(net->layers[i])) all.push_back(i);
+  }
+  std::vector<int> layers;
+  for (int head : heads) {
+    if (head >= 0 && head < (int) all.size()) layers.push_back(all[head]);
+  }
+  return layers;
+}
+
+} /* namespace */
+
+std::vector<DetectionHead> detectionHeads(network *net)
+{
+  std::vector<DetectionHead> heads;
+  for (int i = 0; i < net->n; ++i) {
+    const layer& l = net->layers[i];
+    if (!isDetectionLayer(l)) continue;
+    DetectionHead head;
+    head.output = l.output;
+    head.size = l.outputs;
+    head.width = l.type == DETECTION ? l.side : l.w;
+    head.height = l.type == DETECTION ? l.side : l.h;
+    head.anchors = l.n;
+    // One box per anchor and cell.
+    head.boxes = head.width * head.height * head.anchors;
+    head.classes = l.classes;
+    heads.push_back(head);
+  }
+  return heads;
+}
+
+detection *headDetections(network *net, const std::vector<int>& heads, int width, int height, float thresh,
+                          float hier, int *count)
+{
+  // make_network_boxes and fill_network_boxes restricted to the listed heads.
+  const std::vector<int> layers = headLayers(net, heads);
+  int boxes = 0;
+  for (int index : layers) {
+    const layer& l = net->layers[index];
+    boxes += l.type == YOLO ? yolo_num_detections(l, thresh) : l.w * l.h * l.n;
+  }
+  *count = boxes;
+
+  detection *dets = (detection *) calloc(boxes, sizeof(detection));
+  if (layers.empty()) return dets;
+  const layer& first = net->layers[layers.front()];
+  for (int i = 0; i < boxes; ++i) {
+    dets[i].prob = (float *) calloc(first.classes, sizeof(float));
+    if (first.coords > 4) dets[i].mask = (float *) calloc(first.coords - 4, sizeof(float));
+  }
+
+  detection *next = dets;
+  for (int index : layers) {
+    const layer& l = net->layers[index];
+    if (l.type == YOLO) {
+      next += get_yolo_detections(l, width, height, net->w, net->h, thresh, 0, 1, next);
+    } else if (l.type == REGION) {
+      get_region_detections(l, width, height, net->w, net->h, thresh, 0, hier, 1, next);
+      next += l.w * l.h * l.n;
+    } else {
+      get_detection_detections(l, width, height, thresh, next);
+      next += l.w * l.h * l.n;
+    }
+  }
+  return dets;
+}
+
+} /* namespace darknet_ros*/
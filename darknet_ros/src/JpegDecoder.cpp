@@ -0,0 +1,110 @@
+/*
+ * JpegDecoder.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "darknet_ros/JpegDecoder.hpp"
+
+// c++
+#include <algorithm>
+#include <csetjmp>
+#include <cstdio>
+
+// libjpeg
+#include <jpeglib.h>
+
+namespace darknet_ros {
+
+namespace {
+
+struct ErrorManager
+{
+  jpeg_error_mgr base;
+  jmp_buf jump;
+};
+
+//! libjpeg's default handler exits the process; jump back to decode() instead.
+void exitOnError(j_common_ptr info)
+{
+  ErrorManager *errors = reinterpret_cast<ErrorManager *>(info->err);
+  longjmp(errors->jump, 1);
+}
+
+void ignoreMessage(j_common_ptr info)
+{
+}
+
+} /* namespace */
+
+bool JpegDecoder::isJpeg(const unsigned char *data, size_t size)
+{
+  return size > 2 && data[0] == 0xff && data[1] == 0xd8;
+}
+
+int JpegDecoder::scaleDenominator(int width, int height, int targetWidth, int targetHeight)
+{
+  if (width <= 0 || height <= 0) return 1;
+  int denominator = 8;
+  while (denominator > 1) {
+    // Size libjpeg produces at this scale, which rounds up.
+    const int w = (width + denominator - 1) / denominator;
+    const int h = (height + denominator - 1) / denominator;
+    // Letterboxing fits the image into the target keeping its aspect ratio.
+    const bool widthLimited = (long) targetWidth * height <= (long) targetHeight * width;
+    if (widthLimited ? w >= targetWidth : h >= targetHeight) break;
+    denominator /= 2;
+  }
+  return denominator;
+}
+
+bool JpegDecoder::decode(const unsigned char *data, size_t size, int targetWidth, int targetHeight,
+                         cv::Mat *bgr, int *fullWidth, int *fullHeight)
+{
+  if (!isJpeg(data, size)) return false;
+
+  jpeg_decompress_struct info;
+  ErrorManager errors;
+  info.err = jpeg_std_error(&errors.base);
+  errors.base.error_exit = exitOnError;
+  errors.base.output_message = ignoreMessage;
+  if (setjmp(errors.jump)) {
+    jpeg_destroy_decompress(&info);
+    return false;
+  }
+
+  jpeg_create_decompress(&info);
+  jpeg_mem_src(&info, const_cast<unsigned char *>(data), size);
+  jpeg_read_header(&info, TRUE);
+  *fullWidth = info.image_width;
+  *fullHeight = info.image_height;
+
+  info.scale_num = 1;
+  info.scale_denom = scaleDenominator(info.image_width, info.image_height, targetWidth, targetHeight);
+#ifdef JCS_EXTENSIONS
+  info.out_color_space = JCS_EXT_BGR;
+#else
+  info.out_color_space = JCS_RGB;
+#endif
+  jpeg_start_decompress(&info);
+
+  bgr->create(info.output_height, info.output_width, CV_8UC3);
+  while (info.output_scanline < info.output_height) {
+    JSAMPROW row = bgr->ptr<unsigned char>(info.output_scanline);
+    jpeg_read_scanlines(&info, &row, 1);
+  }
+  jpeg_finish_decompress(&info);
+  jpeg_destroy_decompress(&info);
+
+#ifndef JCS_EXTENSIONS
+  for (int y = 0; y < bgr->rows; ++y) {
+    unsigned char *pixel = bgr->ptr<unsigned char>(y);
+    for (int x = 0; x < bgr->cols; ++x, pixel += 3) {
+      std::swap(pixel[0], pixel[2]);
+    }
+  }
+#endif
+  return true;
+}
+
+} /* namespace darknet_ros*/
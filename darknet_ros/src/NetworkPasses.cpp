@@ -0,0 +1,380 @@
+/*
+ * NetworkPasses.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "darknet_ros/NetworkPasses.hpp"
+
+// c++
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+extern "C" {
+#include "activations.h"
+}
+
+namespace darknet_ros {
+
+namespace {
+
+//! Forward of a route whose inputs already sit in its output buffer.
+void forwardRouteView(layer l, network net)
+{
+}
+
+/*
+ * Layers whose forward overwrites their whole output and never reads it back, so their output
+ * can live anywhere.
+ */
+bool canRedirectOutput(const layer& l)
+{
+  return l.type == CONVOLUTIONAL || l.type == UPSAMPLE || l.type == SHORTCUT || l.type == MAXPOOL;
+}
+
+
+//! Per-channel flags of one layer output; true means the channel may be removed.
+typedef std::vector<char> ChannelMask;
+
+bool isPrunableConvolution(const layer& l)
+{
+  return l.type == CONVOLUTIONAL && l.groups == 1 && !l.xnor && !l.binary;
+}
+
+/*
+ * Output channels of a convolution that are constant zero: all weights are zero and batch
+ * norm/bias plus activation map the resulting zero to zero.
+ */
+ChannelMask zeroFilters(const layer& l)
+{
+  ChannelMask mask(l.out_c, 0);
+  if (!isPrunableConvolution(l)) return mask;
+
+  const int filterSize = l.c * l.size * l.size;
+  int removable = 0;
+  for (int k = 0; k < l.n; ++k) {
+    const float *filter = l.weights + k * filterSize;
+    bool zero = true;
+    for (int i = 0; i < filterSize && zero; ++i) {
+      zero = filter[i] == 0;
+    }
+    if (!zero) continue;
+    float constant = l.biases[k];
+    if (l.batch_normalize) {
+      constant += l.scales[k] * -l.rolling_mean[k] / (std::sqrt(l.rolling_variance[k]) + .000001f);
+    }
+    mask[k] = activate(constant, l.activation) == 0;
+    removable += mask[k];
+  }
+  // A layer needs at least one output channel.
+  if (removable == l.n) mask[0] = 0;
+  return mask;
+}
+
+//! Layers whose output channels map one to one onto the channels of their input.
+bool isChannelwise(const layer& l)
+{
+  return (l.type == UPSAMPLE || l.type == MAXPOOL) && l.c == l.out_c;
+}
+
+/*
+ * Removed channels of a shortcut are zero in both inputs; they are only zero in its output
+ * too if its activation maps 0 to 0 (not so for logistic, for example).
+ */
+bool isPrunableShortcut(const network *net, int i)
+{
+  const layer& l = net->layers[i];
+  if (l.type != SHORTCUT || i == 0 || activate(0, l.activation) != 0) return false;
+  const layer& from = net->layers[l.index];
+  const layer& in = net->layers[i - 1];
+  return from.out_c == l.out_c && from.out_w == l.out_w && from.out_h == l.out_h && in.out_c == l.out_c;
+}
+
+bool restrictMask(ChannelMask *mask, const ChannelMask& allowed, int offset = 0)
+{
+  bool changed = false;
+  for (size_t k = 0; k < mask->size(); ++k) {
+    if ((*mask)[k] && !allowed[offset + k]) {
+      (*mask)[k] = 0;
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+bool clearMask(ChannelMask *mask)
+{
+  return restrictMask(mask, ChannelMask(mask->size(), 0));
+}
+
+template <typename T>
+void compactChannels(T *values, const ChannelMask& removed, int stride)
+{
+  int kept = 0;
+  for (size_t k = 0; k < removed.size(); ++k) {
+    if (removed[k]) continue;
+    if ((int) k != kept) {
+      std::copy(values + k * stride, values + (k + 1) * stride, values + kept * stride);
+    }
+    ++kept;
+  }
+}
+
+int countKept(const ChannelMask& removed)
+{
+  int kept = 0;
+  for (char flag : removed) {
+    kept += !flag;
+  }
+  return kept;
+}
+
+void removeConvolutionChannels(layer *l, const ChannelMask& removedOut, const ChannelMask& removedIn)
+{
+  const int area = l->size * l->size;
+  const int inputs = countKept(removedIn);
+  const int outputs = countKept(removedOut);
+
+  // Compacting front to back never overwrites weights that are still to be moved.
+  int next = 0;
+  for (int k = 0; k < l->n; ++k) {
+    if (removedOut[k]) continue;
+    for (int ch = 0; ch < l->c; ++ch) {
+      if (removedIn[ch]) continue;
+      const float *source = l->weights + (k * l->c + ch) * area;
+      std::copy(source, source + area, l->weights + next * area);
+      ++next;
+    }
+  }
+  compactChannels(l->biases, removedOut, 1);
+  if (l->batch_normalize) {
+    compactChannels(l->scales, removedOut, 1);
+    compactChannels(l->rolling_mean, removedOut, 1);
+    compactChannels(l->rolling_variance, removedOut, 1);
+  }
+
+  l->c = inputs;
+  l->n = l->out_c = outputs;
+  l->nweights = inputs * outputs * area;
+  l->nbiases = outputs;
+  l->inputs = l->h * l->w * l->c;
+  l->outputs = l->out_h * l->out_w * l->out_c;
+  l->workspace_size = (size_t) l->out_h * l->out_w * area * l->c * sizeof(float);
+}
+
+} /* namespace */
+
+bool isDetectionLayer(const layer& l)
+{
+  return l.type == YOLO || l.type == REGION || l.type == DETECTION;
+}
+
+int pruneDetectionHeads(network *net, const std::vector<int>& keep)
+{
+  std::vector<int> heads;
+  for (int i = 0; i < net->n; ++i) {
+    if (isDetectionLayer(net->layers[i])) heads.push_back(i);
+  }
+
+  std::vector<bool> live(net->n, false);
+  bool anyHead = false;
+  for (int head : keep) {
+    if (head < 0 || head >= (int) heads.size()) continue;
+    live[heads[head]] = true;
+    anyHead = true;
+  }
+  if (!anyHead) return -1;
+
+  // A layer stays if any remaining layer reads it; consumers always come after producers.
+  for (int i = net->n - 1; i >= 0; --i) {
+    if (!live[i]) continue;
+    const layer& l = net->layers[i];
+    if (l.type == ROUTE) {
+      for (int j = 0; j < l.n; ++j) {
+        live[l.input_layers[j]] = true;
+      }
+      continue;
+    }
+    if (i > 0) live[i - 1] = true;
+    if (l.type == SHORTCUT) live[l.index] = true;
+  }
+
+  std::vector<int> remap(net->n, -1);
+  int kept = 0;
+  for (int i = 0; i < net->n; ++i) {
+    if (live[i]) remap[i] = kept++;
+  }
+
+  for (int i = 0; i < net->n; ++i) {
+    if (!live[i]) {
+      free_layer(net->layers[i]);
+      continue;
+    }
+    layer l = net->layers[i];
+    if (l.type == ROUTE) {
+      for (int j = 0; j < l.n; ++j) {
+        l.input_layers[j] = remap[l.input_layers[j]];
+      }
+    } else if (l.type == SHORTCUT) {
+      l.index = remap[l.index];
+    }
+    net->layers[remap[i]] = l;
+  }
+
+  const int removed = net->n - kept;
+  net->n = kept;
+  net->output = net->layers[kept - 1].output;
+  net->outputs = net->layers[kept - 1].outputs;
+  return removed;
+}
+
+int pruneZeroChannels(network *net)
+{
+  const int n = net->n;
+  std::vector<ChannelMask> removable(n);
+  for (int i = 0; i < n; ++i) {
+    const layer& l = net->layers[i];
+    removable[i] = l.type == CONVOLUTIONAL ? zeroFilters(l) : ChannelMask(l.out_c, 1);
+  }
+
+  // Shrink the masks until producers and consumers of every tensor agree.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+
+    // What a layer can drop given what its inputs drop.
+    for (int i = 0; i < n; ++i) {
+      const layer& l = net->layers[i];
+      if (l.type == CONVOLUTIONAL) continue;
+      if (l.type == ROUTE) {
+        int offset = 0;
+        for (int j = 0; j < l.n; ++j) {
+          const ChannelMask& input = removable[l.input_layers[j]];
+          for (size_t k = 0; k < input.size() && offset + k < removable[i].size(); ++k) {
+            if (removable[i][offset + k] && !input[k]) {
+              removable[i][offset + k] = 0;
+              changed = true;
+            }
+          }
+          offset += input.size();
+        }
+      } else if (isPrunableShortcut(net, i)) {
+        changed |= restrictMask(&removable[i], removable[i - 1]);
+        changed |= restrictMask(&removable[i], removable[l.index]);
+      } else if (isChannelwise(l) && i > 0) {
+        changed |= restrictMask(&removable[i], removable[i - 1]);
+      } else {
+        changed |= clearMask(&removable[i]);
+      }
+    }
+
+    // What a layer forces its inputs to keep.
+    for (int i = n - 1; i >= 0; --i) {
+      const layer& l = net->layers[i];
+      if (l.type == ROUTE) {
+        int offset = 0;
+        for (int j = 0; j < l.n; ++j) {
+          ChannelMask& input = removable[l.input_layers[j]];
+          changed |= restrictMask(&input, removable[i], offset);
+          offset += input.size();
+        }
+      } else if (i == 0) {
+        continue;
+      } else if (isPrunableConvolution(l) && net->layers[i - 1].out_c == l.c) {
+        continue;
+      } else if (isPrunableShortcut(net, i)) {
+        changed |= restrictMask(&removable[i - 1], removable[i]);
+        changed |= restrictMask(&removable[l.index], removable[i]);
+      } else if (isChannelwise(l)) {
+        changed |= restrictMask(&removable[i - 1], removable[i]);
+      } else {
+        changed |= clearMask(&removable[i - 1]);
+        if (l.type == SHORTCUT) changed |= clearMask(&removable[l.index]);
+      }
+    }
+  }
+
+  // Rebuild the layers front to back so every consumer sees the final producer shapes.
+  int removed = 0;
+  for (int i = 0; i < n; ++i) {
+    layer& l = net->layers[i];
+    const int kept = countKept(removable[i]);
+    if (l.type == CONVOLUTIONAL) {
+      const bool prunedInput = i > 0 && (int) removable[i - 1].size() == l.c;
+      const ChannelMask removedIn = prunedInput ? removable[i - 1] : ChannelMask(l.c, 0);
+      if (kept == l.out_c && countKept(removedIn) == l.c) continue;
+      removed += l.out_c - kept;
+      removeConvolutionChannels(&l, removable[i], removedIn);
+    } else if (l.type == ROUTE) {
+      l.outputs = 0;
+      l.out_c = 0;
+      for (int j = 0; j < l.n; ++j) {
+        const layer& input = net->layers[l.input_layers[j]];
+        l.input_sizes[j] = input.outputs;
+        l.outputs += input.outputs;
+        l.out_c += input.out_c;
+      }
+      l.inputs = l.outputs;
+    } else if (kept != l.out_c) {
+      l.c = l.out_c = kept;
+      l.inputs = l.h * l.w * l.c;
+      l.outputs = l.out_h * l.out_w * l.out_c;
+    }
+  }
+  return removed;
+}
+
+int fuseRouteConcatenations(network *net)
+{
+  if (net->batch != 1) return 0;
+
+  int fused = 0;
+  std::vector<bool> redirected(net->n, false);
+
+  // Concatenations: every producer writes into its slice of the route output.
+  for (int i = 0; i < net->n; ++i) {
+    layer& route = net->layers[i];
+    if (route.type != ROUTE || route.n < 2) continue;
+
+    bool fusable = true;
+    for (int j = 0; j < route.n && fusable; ++j) {
+      const int index = route.input_layers[j];
+      fusable = index < i && !redirected[index] && canRedirectOutput(net->layers[index])
+          && net->layers[index].outputs == route.input_sizes[j];
+      for (int k = 0; k < j && fusable; ++k) {
+        fusable = route.input_layers[k] != index;
+      }
+    }
+    if (!fusable) continue;
+
+    int offset = 0;
+    for (int j = 0; j < route.n; ++j) {
+      const int index = route.input_layers[j];
+      free(net->layers[index].output);
+      net->layers[index].output = route.output + offset;
+      redirected[index] = true;
+      offset += route.input_sizes[j];
+    }
+    route.forward = forwardRouteView;
+    ++fused;
+  }
+
+  // Single-input routes alias their input, which by now is at its final place.
+  for (int i = 0; i < net->n; ++i) {
+    layer& route = net->layers[i];
+    if (route.type != ROUTE || route.n != 1 || route.forward == forwardRouteView) continue;
+    const int index = route.input_layers[0];
+    if (index >= i || net->layers[index].outputs != route.outputs) continue;
+    free(route.output);
+    route.output = net->layers[index].output;
+    route.forward = forwardRouteView;
+    ++fused;
+  }
+
+  net->output = net->layers[net->n - 1].output;
+  return fused;
+}
+
+} /* namespace darknet_ros*/
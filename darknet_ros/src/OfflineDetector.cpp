@@ -0,0 +1,125 @@
+/*
+ * OfflineDetector.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "darknet_ros/OfflineDetector.hpp"
+
+// c++
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+
+// POSIX
+#include <dirent.h>
+
+// darknet_ros
+#include "darknet_ros/DetectionBoxes.hpp"
+#ifdef DARKNET_ROS_ONNXRUNTIME
+#include "darknet_ros/OnnxBackend.hpp"
+#endif
+
+namespace darknet_ros {
+
+OfflineDetector::OfflineDetector(const Options& options)
+    : options_(options)
+{
+#ifdef DARKNET_ROS_ONNXRUNTIME
+  if (options_.backend == "onnxruntime") {
+    OnnxBackend::Options onnxOptions;
+    onnxOptions.threads = options_.onnxThreads;
+    onnxOptions.executionProvider = options_.executionProvider;
+    backend_.reset(new OnnxBackend(onnxOptions));
+  }
+#endif
+  if (options_.backend == "darknet") {
+    backend_.reset(new DarknetBackend(options_.darknet));
+  }
+}
+
+bool OfflineDetector::load(const std::string& config, const std::string& model)
+{
+  if (!backend_ || !backend_->load(config, model)) return false;
+
+  // The main heads of the node without head sets.
+  const std::vector<DetectionHead>& heads = backend_->heads();
+  heads_ = mainDetectionHeads(heads, std::vector<bool>(heads.size(), false));
+  classes_ = heads_.empty() ? 0 : heads[heads_.front()].classes;
+  return !heads_.empty();
+}
+
+image OfflineDetector::makeInput() const
+{
+  return make_image(backend_->inputWidth(), backend_->inputHeight(), backend_->inputChannels());
+}
+
+void OfflineDetector::detect(image input, int width, int height, std::vector<OfflineDetection> *detections)
+{
+  backend_->run(input.data);
+
+  int nboxes = 0;
+  detection *dets = backend_->detections(heads_, width, height, options_.threshold, options_.hier, &nboxes);
+  suppressDetections(dets, nboxes, classes_, options_.nms);
+  collectFrameBoxes(dets, nboxes, classes_, &boxes_);
+  free_detections(dets, nboxes);
+
+  detections->clear();
+  for (const FrameBox& b : boxes_) {
+    detections->push_back({b.classId, b.probability, b.xmin * width, b.ymin * height, b.xmax * width,
+                           b.ymax * height});
+  }
+}
+
+std::vector<std::string> listImages(const std::string& directory)
+{
+  std::vector<std::string> files;
+  DIR *dir = opendir(directory.c_str());
+  if (!dir) return files;
+  while (struct dirent *entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    const size_t dot = name.rfind('.');
+    if (dot == std::string::npos) continue;
+    std::string extension = name.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == "jpg" || extension == "jpeg" || extension == "png" || extension == "bmp") {
+      files.push_back(directory + "/" + name);
+    }
+  }
+  closedir(dir);
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+bool loadImageFrame(const std::string& file, CameraFrame *frame)
+{
+  // darknet exits on files it cannot open.
+  FILE *readable = fopen(file.c_str(), "rb");
+  if (!readable) return false;
+  fclose(readable);
+
+  image loaded = load_image_color(const_cast<char *>(file.c_str()), 0, 0);
+  if (!loaded.data) return false;
+
+  boost::shared_ptr<std::vector<unsigned char> > pixels(
+      new std::vector<unsigned char>(loaded.w * loaded.h * 3));
+  unsigned char *rgb = pixels->data();
+  const int plane = loaded.w * loaded.h;
+  for (int i = 0; i < plane; ++i) {
+    for (int k = 0; k < 3; ++k) {
+      rgb[3 * i + k] = (unsigned char) (loaded.data[k * plane + i] * 255 + .5f);
+    }
+  }
+
+  frame->owner = pixels;
+  frame->data = rgb;
+  frame->width = loaded.w;
+  frame->height = loaded.h;
+  frame->step = 3 * loaded.w;
+  frame->format = PixelFormat::RGB8;
+  frame->bigEndian = false;
+  free_image(loaded);
+  return true;
+}
+
+} /* namespace darknet_ros*/
@@ -0,0 +1,181 @@
+/*
+ * OnnxBackend.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "darknet_ros/OnnxBackend.hpp"
+
+// c++
+#include <algorithm>
+
+// ROS
+#include <ros/console.h>
+
+// ONNX Runtime
+#include <onnxruntime_cxx_api.h>
+
+// darknet_ros
+#include "darknet_ros/NetworkPasses.hpp"
+
+extern "C" {
+#include "blas.h"
+#include "parser.h"
+}
+
+namespace darknet_ros {
+
+struct OnnxBackend::Session
+{
+  Session(const std::string& model, const Ort::SessionOptions& options)
+      : env(ORT_LOGGING_LEVEL_WARNING, "darknet_ros"),
+        session(env, model.c_str(), options),
+        memory(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)),
+        binding(session)
+  {
+  }
+
+  Ort::Env env;
+  Ort::Session session;
+  Ort::MemoryInfo memory;
+  Ort::IoBinding binding;
+  std::string inputName;
+  std::vector<int64_t> inputShape;
+
+  //! Per model output: the head layer it feeds and the buffer it is bound to.
+  std::vector<int> headLayers;
+  std::vector<std::vector<float> > outputs;
+};
+
+OnnxBackend::OnnxBackend(const Options& options)
+    : options_(options)
+{
+}
+
+OnnxBackend::~OnnxBackend()
+{
+}
+
+bool OnnxBackend::load(const std::string& config, const std::string& model)
+{
+  net_ = parse_network_cfg(const_cast<char *>(config.c_str()));
+  if (!net_) return false;
+  set_batch_network(net_, 1);
+
+  std::vector<int> headLayers;
+  for (int i = 0; i < net_->n; ++i) {
+    if (isDetectionLayer(net_->layers[i])) headLayers.push_back(i);
+  }
+
+  try {
+    Ort::SessionOptions options;
+    options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+    options.SetInterOpNumThreads(1);
+    if (options_.threads > 0) options.SetIntraOpNumThreads(options_.threads);
+    if (options_.executionProvider == "openvino") {
+      try {
+        options.AppendExecutionProvider_OpenVINO(OrtOpenVINOProviderOptions());
+      } catch (const Ort::Exception& e) {
+        ROS_WARN("[YoloObjectDetector] OpenVINO execution provider not available (%s), using the CPU one.",
+                 e.what());
+      }
+    } else if (options_.executionProvider != "cpu") {
+      ROS_WARN("[YoloObjectDetector] Unknown execution provider %s, using the CPU one.",
+               options_.executionProvider.c_str());
+    }
+    session_.reset(new Session(model, options));
+
+    Ort::Session& session = session_->session;
+    Ort::AllocatorWithDefaultOptions allocator;
+    if (session.GetInputCount() != 1) {
+      ROS_ERROR("[YoloObjectDetector] %s has %d inputs, expected one image.", model.c_str(),
+                (int) session.GetInputCount());
+      return false;
+    }
+    session_->inputName = session.GetInputNameAllocated(0, allocator).get();
+    session_->inputShape = {1, net_->c, net_->h, net_->w};
+    Ort::TypeInfo inputInfo = session.GetInputTypeInfo(0);
+    const std::vector<int64_t> inputShape = inputInfo.GetTensorTypeAndShapeInfo().GetShape();
+    for (size_t i = 1; i < inputShape.size() && i < 4; ++i) {
+      if (inputShape[i] > 0 && inputShape[i] != session_->inputShape[i]) {
+        ROS_ERROR("[YoloObjectDetector] Input of %s does not match the %dx%dx%d input of the cfg.", model.c_str(),
+                  net_->c, net_->h, net_->w);
+        return false;
+      }
+    }
+
+    // Outputs are matched to heads by size, exporters do not keep the order of the cfg.
+    std::vector<bool> taken(headLayers.size(), false);
+    const size_t outputs = session.GetOutputCount();
+    for (size_t j = 0; j < outputs; ++j) {
+      Ort::TypeInfo outputInfo = session.GetOutputTypeInfo(j);
+      const std::vector<int64_t> shape = outputInfo.GetTensorTypeAndShapeInfo().GetShape();
+      int64_t size = 1;
+      for (size_t i = 0; i < shape.size(); ++i) {
+        size *= (i == 0 && shape[i] <= 0) ? 1 : shape[i];
+      }
+      size_t head = 0;
+      while (head < headLayers.size() && (taken[head] || net_->layers[headLayers[head]].inputs != size)) {
+        ++head;
+      }
+      const std::string name = session.GetOutputNameAllocated(j, allocator).get();
+      if (head == headLayers.size()) {
+        ROS_ERROR("[YoloObjectDetector] Output %s of %s matches no detection layer of the cfg.", name.c_str(),
+                  model.c_str());
+        return false;
+      }
+      taken[head] = true;
+      session_->headLayers.push_back(headLayers[head]);
+      session_->outputs.push_back(std::vector<float>(size));
+      std::vector<int64_t> bound(shape);
+      if (!bound.empty() && bound[0] <= 0) bound[0] = 1;
+      session_->binding.BindOutput(name.c_str(), Ort::Value::CreateTensor<float>(
+          session_->memory, session_->outputs.back().data(), size, bound.data(), bound.size()));
+    }
+    if (std::find(taken.begin(), taken.end(), false) != taken.end()) {
+      ROS_ERROR("[YoloObjectDetector] %s has no output for some detection layers of the cfg.", model.c_str());
+      return false;
+    }
+  } catch (const Ort::Exception& e) {
+    ROS_ERROR("[YoloObjectDetector] ONNX Runtime could not load %s: %s", model.c_str(), e.what());
+    return false;
+  }
+
+  heads_ = detectionHeads(net_);
+  return true;
+}
+
+void OnnxBackend::run(float *input)
+{
+  Session& s = *session_;
+  try {
+    const size_t size = net_->c * net_->h * net_->w;
+    s.binding.BindInput(s.inputName.c_str(), Ort::Value::CreateTensor<float>(
+        s.memory, input, size, s.inputShape.data(), s.inputShape.size()));
+    s.session.Run(Ort::RunOptions{nullptr}, s.binding);
+  } catch (const Ort::Exception& e) {
+    ROS_ERROR_THROTTLE(1, "[YoloObjectDetector] ONNX Runtime failed: %s", e.what());
+    for (const DetectionHead& head : heads_) {
+      fill_cpu(head.size, 0, head.output, 1);
+    }
+    return;
+  }
+
+  // The cfg's detection layers activate the raw outputs, as after darknet's own forward pass.
+  for (size_t j = 0; j < s.headLayers.size(); ++j) {
+    layer l = net_->layers[s.headLayers[j]];
+    network state = *net_;
+    state.input = s.outputs[j].data();
+    state.index = s.headLayers[j];
+    state.train = 0;
+    l.forward(l, state);
+  }
+}
+
+detection *OnnxBackend::detections(const std::vector<int>& heads, int width, int height, float thresh,
+                                    float hier, int *count)
+{
+  return headDetections(net_, heads, width, height, thresh, hier, count);
+}
+
+} /* namespace darknet_ros*/
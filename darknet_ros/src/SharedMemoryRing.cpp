@@ -0,0 +1,183 @@
+/*
+ * SharedMemoryRing.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "darknet_ros/SharedMemoryRing.hpp"
+
+// c++
+#include <algorithm>
+#include <cstring>
+
+// POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace darknet_ros {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "The seqlock needs address free 64 bit atomics.");
+
+namespace {
+
+const size_t Alignment = 64;
+
+size_t alignUp(size_t size)
+{
+  return (size + Alignment - 1) / Alignment * Alignment;
+}
+
+SharedMemoryRing::SlotHeader *slotAt(const SharedMemoryRing::Header *header, uint32_t slot)
+{
+  const char *base = reinterpret_cast<const char *>(header) + header->slotsOffset;
+  return reinterpret_cast<SharedMemoryRing::SlotHeader *>(const_cast<char *>(base) +
+                                                          (size_t) slot * header->slotStride);
+}
+
+} /* namespace */
+
+SharedMemoryRing::SharedMemoryRing(const std::string& name, uint32_t magic, uint32_t slotCount, size_t slotSize)
+    : name_(name),
+      slotSize_(slotSize)
+{
+  if (slotCount == 0) return;
+  const size_t slotsOffset = alignUp(sizeof(Header));
+  const size_t slotStride = alignUp(sizeof(SlotHeader)) + alignUp(slotSize);
+  const size_t size = slotsOffset + slotCount * slotStride;
+
+  // A segment left behind by a crashed node may still be mapped by readers with an old layout.
+  shm_unlink(name_.c_str());
+  int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) return;
+  if (ftruncate(fd, size) != 0) {
+    close(fd);
+    shm_unlink(name_.c_str());
+    return;
+  }
+  void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    shm_unlink(name_.c_str());
+    return;
+  }
+  mappedSize_ = size;
+
+  // The segment is zero filled: every slot starts at the even sequence 0.
+  header_ = static_cast<Header *>(memory);
+  header_->version = Version;
+  header_->slotCount = slotCount;
+  header_->slotSize = slotSize;
+  header_->slotStride = slotStride;
+  header_->slotsOffset = slotsOffset;
+  header_->written.store(0, std::memory_order_relaxed);
+  // Readers check the magic last.
+  std::atomic_thread_fence(std::memory_order_release);
+  header_->magic = magic;
+}
+
+SharedMemoryRing::~SharedMemoryRing()
+{
+  if (!header_) return;
+  munmap(header_, mappedSize_);
+  shm_unlink(name_.c_str());
+}
+
+void *SharedMemoryRing::beginWrite(uint32_t *slot)
+{
+  writing_ = header_->written.load(std::memory_order_relaxed) % header_->slotCount;
+  SlotHeader *target = slotAt(header_, writing_);
+  target->sequence.store(target->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  *slot = writing_;
+  return reinterpret_cast<char *>(target) + alignUp(sizeof(SlotHeader));
+}
+
+uint64_t SharedMemoryRing::commit(uint64_t stamp, size_t size)
+{
+  SlotHeader *target = slotAt(header_, writing_);
+  target->stamp = stamp;
+  target->size = size;
+  const uint64_t sequence = target->sequence.load(std::memory_order_relaxed) + 1;
+  target->sequence.store(sequence, std::memory_order_release);
+  header_->written.fetch_add(1, std::memory_order_release);
+  return sequence;
+}
+
+size_t SharedMemoryRing::payloadOffset(uint32_t slot) const
+{
+  return header_->slotsOffset + (size_t) slot * header_->slotStride + alignUp(sizeof(SlotHeader));
+}
+
+SharedMemoryRingReader::~SharedMemoryRingReader()
+{
+  if (header_) munmap(const_cast<SharedMemoryRing::Header *>(header_), mappedSize_);
+}
+
+bool SharedMemoryRingReader::open(const std::string& name, uint32_t magic)
+{
+  if (header_) munmap(const_cast<SharedMemoryRing::Header *>(header_), mappedSize_);
+  header_ = nullptr;
+
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) return false;
+  struct stat status;
+  if (fstat(fd, &status) != 0 || (size_t) status.st_size < sizeof(SharedMemoryRing::Header)) {
+    close(fd);
+    return false;
+  }
+  void *memory = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) return false;
+
+  const SharedMemoryRing::Header *header = static_cast<const SharedMemoryRing::Header *>(memory);
+  const uint32_t found = header->magic;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (found != magic || header->version != SharedMemoryRing::Version ||
+      header->slotsOffset + (size_t) header->slotCount * header->slotStride > (size_t) status.st_size) {
+    munmap(memory, status.st_size);
+    return false;
+  }
+  header_ = header;
+  mappedSize_ = status.st_size;
+  return true;
+}
+
+const void *SharedMemoryRingReader::payload(uint32_t slot) const
+{
+  return reinterpret_cast<const char *>(slotAt(header_, slot)) + alignUp(sizeof(SharedMemoryRing::SlotHeader));
+}
+
+uint64_t SharedMemoryRingReader::sequence(uint32_t slot) const
+{
+  return slotAt(header_, slot)->sequence.load(std::memory_order_acquire);
+}
+
+bool SharedMemoryRingReader::unchanged(uint32_t slot, uint64_t sequence) const
+{
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return (sequence & 1) == 0 && slotAt(header_, slot)->sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+size_t SharedMemoryRingReader::readLatest(void *buffer, size_t size, uint64_t *stamp) const
+{
+  // Only a writer lapping the whole ring during the copy makes a retry necessary.
+  for (int attempt = 0; attempt < 3; ++attempt) {
+    const uint64_t written = header_->written.load(std::memory_order_acquire);
+    if (written == 0) return 0;
+    const uint32_t slot = (written - 1) % header_->slotCount;
+    const SharedMemoryRing::SlotHeader *source = slotAt(header_, slot);
+    const uint64_t before = sequence(slot);
+    if (before & 1) continue;
+    const size_t copied = std::min<size_t>(size, std::min<size_t>(source->size, header_->slotSize));
+    const uint64_t copiedStamp = source->stamp;
+    memcpy(buffer, payload(slot), copied);
+    if (!unchanged(slot, before)) continue;
+    if (stamp) *stamp = copiedStamp;
+    return copied;
+  }
+  return 0;
+}
+
+} /* namespace darknet_ros*/
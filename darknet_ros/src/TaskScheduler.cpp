@@ -0,0 +1,256 @@
+/*
+ * TaskScheduler.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#include "darknet_ros/TaskScheduler.hpp"
+
+// c++
+#include <algorithm>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace darknet_ros {
+
+namespace {
+
+//! Scheduler and worker index of the calling thread, -1 outside of workers.
+thread_local TaskScheduler *currentScheduler = nullptr;
+thread_local int currentWorker = -1;
+//! The calling thread runs submitted tasks of a scheduler without workers.
+thread_local bool runningInline = false;
+
+std::atomic<TaskScheduler*> defaultScheduler(nullptr);
+
+} /* namespace */
+
+TaskScheduler::TaskScheduler(int threads)
+{
+  // The thread waiting for the tasks works too, it takes one of the cores. A single core gets
+  // no worker at all.
+  const int workers = std::max(1, threads > 0 ? threads : allottedCores()) - 1;
+  for (int i = 0; i < workers; ++i) {
+    workers_.push_back(std::unique_ptr<Worker>(new Worker));
+  }
+  for (int i = 0; i < workers; ++i) {
+    threads_.push_back(std::thread(&TaskScheduler::run, this, i));
+  }
+}
+
+TaskScheduler::~TaskScheduler()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    critical_.clear();
+    injected_.clear();
+  }
+  condition_.notify_all();
+  criticalCondition_.notify_all();
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+  TaskScheduler *self = this;
+  defaultScheduler.compare_exchange_strong(self, nullptr);
+}
+
+void TaskScheduler::submit(const std::function<void()>& task, TaskPriority priority)
+{
+  if (priority == TaskPriority::Normal && currentScheduler == this && currentWorker >= 0) {
+    {
+      std::lock_guard<std::mutex> lock(workers_[currentWorker]->mutex);
+      workers_[currentWorker]->tasks.push_back(task);
+    }
+    // Counted under the mutex, so an idle worker can not miss it.
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++queued_;
+  } else {
+    std::lock_guard<std::mutex> lock(mutex_);
+    (priority == TaskPriority::Critical ? critical_ : injected_).push_back(task);
+    ++queued_;
+  }
+  condition_.notify_one();
+  if (priority == TaskPriority::Critical) criticalCondition_.notify_one();
+
+  // Without workers the submitting thread runs the task, and the tasks it submits in turn
+  // once it is done, instead of recursing. Tasks of groups it waits for meanwhile are taken
+  // by TaskGroup::wait. Critical submitters stay off normal tasks as waiters do.
+  if (!workers_.empty() || runningInline) return;
+  runningInline = true;
+  while (runOne(-1, priority == TaskPriority::Critical)) {
+  }
+  runningInline = false;
+}
+
+void TaskScheduler::parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body,
+                                TaskPriority priority)
+{
+  const int count = end - begin;
+  if (count <= 0) return;
+  const int chunks = std::max(1, std::min(concurrency(), count / std::max(1, grain)));
+  if (chunks == 1) {
+    body(begin, end);
+    return;
+  }
+
+  TaskGroup group(*this, priority);
+  for (int i = 1; i < chunks; ++i) {
+    const int first = begin + (long) count * i / chunks;
+    const int last = begin + (long) count * (i + 1) / chunks;
+    group.run([&body, first, last] { body(first, last); });
+  }
+  body(begin, begin + count / chunks);
+  group.wait();
+}
+
+void TaskScheduler::setDefault(TaskScheduler *scheduler)
+{
+  defaultScheduler = scheduler;
+}
+
+int TaskScheduler::allottedCores()
+{
+#ifdef __linux__
+  cpu_set_t set;
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    return std::max(1, CPU_COUNT(&set));
+  }
+#endif
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void TaskScheduler::run(int index)
+{
+  currentScheduler = this;
+  currentWorker = index;
+  while (true) {
+    if (runOne(index)) continue;
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+    if (stopping_) return;
+  }
+}
+
+bool TaskScheduler::runOne(int self, bool criticalOnly)
+{
+  std::function<void()> task;
+  if (!take(self, criticalOnly, &task)) return false;
+  task();
+  return true;
+}
+
+bool TaskScheduler::take(int self, bool criticalOnly, std::function<void()> *task)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!critical_.empty()) {
+      *task = std::move(critical_.front());
+      critical_.pop_front();
+      --queued_;
+      return true;
+    }
+  }
+  if (criticalOnly) return false;
+  if (self >= 0) {
+    // Own tasks newest first, their data is most likely still in cache.
+    Worker& worker = *workers_[self];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (!worker.tasks.empty()) {
+      *task = std::move(worker.tasks.back());
+      worker.tasks.pop_back();
+      --queued_;
+      return true;
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!injected_.empty()) {
+      *task = std::move(injected_.front());
+      injected_.pop_front();
+      --queued_;
+      return true;
+    }
+  }
+  const int workers = static_cast<int>(workers_.size());
+  for (int i = 1; i <= workers; ++i) {
+    const int victim = (std::max(self, 0) + i) % workers;
+    if (victim == self) continue;
+    Worker& worker = *workers_[victim];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (!worker.tasks.empty()) {
+      *task = std::move(worker.tasks.front());
+      worker.tasks.pop_front();
+      --queued_;
+      return true;
+    }
+  }
+  return false;
+}
+
+void TaskScheduler::idle(bool criticalOnly, const std::function<bool()>& predicate)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (criticalOnly) {
+    criticalCondition_.wait(lock, [&] { return stopping_ || !critical_.empty() || predicate(); });
+  } else {
+    condition_.wait(lock, [&] { return stopping_ || queued_ > 0 || predicate(); });
+  }
+}
+
+void TaskScheduler::notifyAll()
+{
+  {
+    // Taking the mutex orders this after a waiter that checked its predicate.
+    std::lock_guard<std::mutex> lock(mutex_);
+  }
+  condition_.notify_all();
+  criticalCondition_.notify_all();
+}
+
+TaskGroup::TaskGroup(TaskScheduler& scheduler, TaskPriority priority)
+    : scheduler_(scheduler),
+      priority_(priority),
+      pending_(std::make_shared<std::atomic<int> >(0))
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+  wait();
+}
+
+void TaskGroup::run(const std::function<void()>& task)
+{
+  ++*pending_;
+  std::shared_ptr<std::atomic<int> > pending = pending_;
+  TaskScheduler *scheduler = &scheduler_;
+  scheduler_.submit([task, pending, scheduler] {
+    task();
+    if (--*pending == 0) scheduler->notifyAll();
+  }, priority_);
+}
+
+void TaskGroup::wait()
+{
+  const int self = currentScheduler == &scheduler_ ? currentWorker : -1;
+  const bool criticalOnly = priority_ == TaskPriority::Critical;
+  while (*pending_ > 0) {
+    if (scheduler_.runOne(self, criticalOnly)) continue;
+    scheduler_.idle(criticalOnly, [this] { return *pending_ == 0; });
+  }
+}
+
+void parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body)
+{
+  TaskScheduler *scheduler = defaultScheduler;
+  if (!scheduler) {
+    if (begin < end) body(begin, end);
+    return;
+  }
+  scheduler->parallelFor(begin, end, grain, body, TaskPriority::Critical);
+}
+
+} /* namespace darknet_ros*/
@@ -8,9 +8,13 @@
 
 // yolo object detector
 #include "darknet_ros/YoloObjectDetector.hpp"
+#include "darknet_ros/DarknetBackend.hpp"
+#ifdef DARKNET_ROS_ONNXRUNTIME
+#include "darknet_ros/OnnxBackend.hpp"
+#endif
 
-// Check for xServer
-#include <X11/Xlib.h>
+// boost
+#include <boost/make_shared.hpp>
 
 #ifdef DARKNET_FILE_PATH
 std::string darknetFilePath_ = DARKNET_FILE_PATH;
@@ -30,15 +34,74 @@ char *cfg;
 char *weights;
 char *data;
 char **detectionNames;
-sem_t sem_new_image_; // Semaphore to indicate new image
+
+namespace {
+
+//! Frame over a BGR matrix, which it shares.
+CameraFrame cameraFrame(const cv::Mat& bgr)
+{
+  CameraFrame frame;
+  frame.owner = boost::make_shared<cv::Mat>(bgr);
+  frame.data = bgr.data;
+  frame.width = bgr.cols;
+  frame.height = bgr.rows;
+  frame.step = bgr.step;
+  frame.format = PixelFormat::BGR8;
+  return frame;
+}
+
+/*
+ * Frame over the pixels of an image message, kept alive by owner. Encodings the converter
+ * does not know are converted to BGR8 by cv_bridge.
+ */
+CameraFrame cameraFrame(const sensor_msgs::Image& msg, const boost::shared_ptr<const void>& owner)
+{
+  CameraFrame frame;
+  if (!parsePixelFormat(msg.encoding, &frame.format)) {
+    return cameraFrame(cv_bridge::toCvCopy(msg, sensor_msgs::image_encodings::BGR8)->image);
+  }
+  frame.owner = owner;
+  frame.data = msg.data.data();
+  frame.width = msg.width;
+  frame.height = msg.height;
+  frame.step = msg.step;
+  frame.bigEndian = msg.is_bigendian;
+  return frame;
+}
+
+/*
+ * Depth map over the data of a message. Encodings other than 16UC1 and 32FC1 are converted
+ * to 32FC1 by cv_bridge.
+ */
+DepthFrame depthFrame(const sensor_msgs::ImageConstPtr& msg)
+{
+  DepthFrame depth;
+  if (DepthFrame::parseEncoding(msg->encoding, &depth.encoding)) {
+    depth.owner = msg;
+    depth.data = msg->data.data();
+    depth.step = msg->step;
+    depth.bigEndian = msg->is_bigendian;
+  } else {
+    cv_bridge::CvImagePtr converted = cv_bridge::toCvCopy(msg, sensor_msgs::image_encodings::TYPE_32FC1);
+    depth.owner = converted;
+    depth.data = converted->image.data;
+    depth.step = converted->image.step;
+  }
+  depth.width = msg->width;
+  depth.height = msg->height;
+  return depth;
+}
+
+//! Time the detection loop waits for a frame before it finishes the frames in the pipeline.
+const std::chrono::milliseconds pipelineFlushTimeout(50);
+
+} /* namespace */
 
 YoloObjectDetector::YoloObjectDetector(ros::NodeHandle nh)
     : nodeHandle_(nh),
       imageTransport_(nodeHandle_),
       numClasses_(0),
       classLabels_(0),
-      rosBoxes_(0),
-      rosBoxCounter_(0),
       imgSync_(ApproxTimePolicy(3), imageSubscriber_, dmapSubscriber_)
 {
   ROS_INFO("[YoloObjectDetector] Node started.");
@@ -57,8 +120,11 @@ YoloObjectDetector::~YoloObjectDetector()
     boost::unique_lock<boost::shared_mutex> lockNodeStatus(mutexNodeStatus_);
     isNodeRunning_ = false;
   }
+  spinners_.clear();
   yoloThread_.join();
-  sem_destroy(&sem_new_image_);
+  viewer_.reset();
+  TaskScheduler::setDefault(nullptr);
+  taskScheduler_.reset();
 }
 
 bool YoloObjectDetector::readParameters()
@@ -66,14 +132,12 @@ bool YoloObjectDetector::readParameters()
   // Load common parameters.
   nodeHandle_.param("image_view/enable_opencv", viewImage_, true);
   nodeHandle_.param("image_view/wait_key_delay", waitKeyDelay_, 3);
+  nodeHandle_.param("image_view/rate", viewRate_, 30.0);
   nodeHandle_.param("image_view/enable_console_output", enableConsoleOutput_, false);
 
-  // Check if Xserver is running on Linux.
-  if (XOpenDisplay(NULL)) {
-    // Do nothing!
-    ROS_INFO("[YoloObjectDetector] Xserver is running.");
-  } else {
-    ROS_INFO("[YoloObjectDetector] Xserver is not running.");
+  // The window needs a GUI build and a running Xserver.
+  if (viewImage_ && !DetectionViewer::displayAvailable()) {
+    ROS_INFO("[YoloObjectDetector] No display available, detection window disabled.");
     viewImage_ = false;
   }
 
@@ -81,8 +145,6 @@ bool YoloObjectDetector::readParameters()
   nodeHandle_.param("yolo_model/detection_classes/names", classLabels_,
                     std::vector<std::string>(0));
   numClasses_ = classLabels_.size();
-  rosBoxes_ = std::vector<std::vector<RosBox_> >(numClasses_);
-  rosBoxCounter_ = std::vector<int>(numClasses_);
 
   return true;
 }
@@ -98,19 +160,85 @@ void YoloObjectDetector::init()
   std::string configModel;
   std::string weightsModel;
 
-  // Initialize semaphore
-  sem_init(&sem_new_image_, 0, 0);
-
   // ZED camera
   nodeHandle_.param("zed_enable", zed, false);
 
+  // All parallel work of the node shares one scheduler, sized to the cores it may use.
+  int threads;
+  nodeHandle_.param("inference/threads", threads, 0);
+  taskScheduler_.reset(new TaskScheduler(threads));
+  TaskScheduler::setDefault(taskScheduler_.get());
+  ROS_INFO("[YoloObjectDetector] Task scheduler runs on %d cores.", taskScheduler_->concurrency());
+
+  DarknetBackend::Options darknetOptions;
+
+  // Detection heads to run, all if empty.
+  nodeHandle_.param("yolo_model/detection_heads/keep", darknetOptions.detectionHeads, std::vector<int>(0));
+
+  // Network input size, the cfg's if 0.
+  nodeHandle_.param("yolo_model/input_size/width", darknetOptions.inputWidth, 0);
+  nodeHandle_.param("yolo_model/input_size/height", darknetOptions.inputHeight, 0);
+
+  // Load-time network rewrites.
+  nodeHandle_.param("inference/prune_zero_channels", darknetOptions.pruneZeroChannels, false);
+  nodeHandle_.param("inference/fuse_routes", darknetOptions.fuseRoutes, false);
+  nodeHandle_.param("inference/vectorized_activations", darknetOptions.vectorizedActivations, true);
+
+  // Convolution autotuning.
+  nodeHandle_.param("inference/autotune/enable", darknetOptions.autotune, false);
+  nodeHandle_.param("inference/autotune/iterations", darknetOptions.tuningIterations, 3);
+  nodeHandle_.param("inference/autotune/cache_file", darknetOptions.tuningCacheFile, std::string(""));
+  if (darknetOptions.tuningCacheFile.empty()) {
+    const char *rosHome = getenv("ROS_HOME");
+    const char *home = getenv("HOME");
+    darknetOptions.tuningCacheFile = rosHome ? std::string(rosHome) : std::string(home ? home : ".") + "/.ros";
+    darknetOptions.tuningCacheFile += "/darknet_ros_convolution.cache";
+  }
+
+  // Engine running the model. Other backends read the model from their own file next to the
+  // darknet weights.
+  std::string backendName;
+  nodeHandle_.param("inference/backend", backendName, std::string("darknet"));
+#ifdef DARKNET_ROS_ONNXRUNTIME
+  if (backendName == "onnxruntime") {
+    OnnxBackend::Options onnxOptions;
+    onnxOptions.threads = taskScheduler_->concurrency();
+    nodeHandle_.param("inference/onnx/execution_provider", onnxOptions.executionProvider, std::string("cpu"));
+    nodeHandle_.param("yolo_model/onnx_file/name", weightsModel, std::string("yolov2-tiny.onnx"));
+    backend_.reset(new OnnxBackend(onnxOptions));
+  }
+#endif
+  if (!backend_) {
+    if (backendName != "darknet") {
+      ROS_WARN("[YoloObjectDetector] Inference backend %s is not available, using darknet.", backendName.c_str());
+    }
+    nodeHandle_.param("yolo_model/weight_file/name", weightsModel, std::string("yolov2-tiny.weights"));
+    backend_.reset(new DarknetBackend(darknetOptions));
+  }
+  ROS_INFO("[YoloObjectDetector] Inference backend: %s.", backend_->name().c_str());
+
   // Threshold of object detection.
   float thresh;
   nodeHandle_.param("yolo_model/threshold/value", thresh, (float) 0.3);
 
+  // Temporal smoothing, either of the raw head outputs over the last frames or of the
+  // decoded boxes.
+  std::string smoothing;
+  int averagedFrames;
+  nodeHandle_.param("yolo_model/temporal_smoothing/mode", smoothing, std::string("tensor"));
+  nodeHandle_.param("yolo_model/temporal_smoothing/frames", averagedFrames, 1);
+  if (smoothing == "boxes") {
+    BoxTracker::Options trackerOptions;
+    nodeHandle_.param("yolo_model/temporal_smoothing/alpha", trackerOptions.alpha, .5f);
+    nodeHandle_.param("yolo_model/temporal_smoothing/min_overlap", trackerOptions.minOverlap, .3f);
+    nodeHandle_.param("yolo_model/temporal_smoothing/max_misses", trackerOptions.maxMisses, 2);
+    boxTracker_.reset(new BoxTracker(trackerOptions));
+    averagedFrames = 1;
+  } else if (smoothing != "tensor") {
+    ROS_WARN("[YoloObjectDetector] Unknown temporal smoothing %s, averaging outputs.", smoothing.c_str());
+  }
+
   // Path to weights file.
-  nodeHandle_.param("yolo_model/weight_file/name", weightsModel,
-                    std::string("yolov2-tiny.weights"));
   nodeHandle_.param("weights_path", weightsPath, std::string("/default"));
   weightsPath += "/" + weightsModel;
   weights = new char[weightsPath.length() + 1];
@@ -138,7 +266,10 @@ void YoloObjectDetector::init()
 
   // Load network.
   setupNetwork(cfg, weights, data, thresh, detectionNames, numClasses_,
-                0, 0, 1, 0.5, 0, 0, 0, 0);
+                0, 0, std::max(1, averagedFrames), 0.5, 0, 0, 0, 0);
+  setupHeadSets();
+  setupHeadTensors();
+  setupDetectionRing();
   yoloThread_ = std::thread(&YoloObjectDetector::yolo, this);
 
   // Initialize publisher and subscriber.
@@ -155,6 +286,8 @@ void YoloObjectDetector::init()
   std::string detectionImageTopicName;
   int detectionImageQueueSize;
   bool detectionImageLatch;
+  std::string heartbeatTopicName;
+  int heartbeatQueueSize;
   std::string ns;
 
   nodeHandle_.getParam("namespace", ns);
@@ -164,6 +297,32 @@ void YoloObjectDetector::init()
   nodeHandle_.param("subscribers/camera_reading/dmap_topic", dmapTopicName,
                     std::string("/camera/dmap"));
   nodeHandle_.param("subscribers/camera_reading/dmap_queue_size", dmapQueueSize, 1);
+  nodeHandle_.param("subscribers/camera_reading/compressed", compressedInput_, false);
+  nodeHandle_.param("subscribers/camera_reading/decode_threads", decodeThreads_, 2);
+  nodeHandle_.param("subscribers/camera_reading/max_frame_age", maxFrameAge_, 0.0);
+  int cameraThreads;
+  int actionThreads;
+  nodeHandle_.param("spinners/camera/threads", cameraThreads, 1);
+  nodeHandle_.param("spinners/actions/threads", actionThreads, 1);
+
+  // Live frames always win over action goals, which win over batch goals. Only the newest
+  // live frame and the current goal wait; batch goals queue up.
+  FrameScheduler::Policy livePolicy;
+  FrameScheduler::Policy goalPolicy;
+  FrameScheduler::Policy batchPolicy;
+  int batchQueueSize;
+  livePolicy.dropOldest = true;
+  goalPolicy.dropOldest = true;
+  nodeHandle_.param("scheduler/live/max_rate", livePolicy.maxRate, 0.0);
+  nodeHandle_.param("scheduler/goal/max_rate", goalPolicy.maxRate, 0.0);
+  nodeHandle_.param("scheduler/batch/max_rate", batchPolicy.maxRate, 0.0);
+  nodeHandle_.param("scheduler/batch/queue_size", batchQueueSize, 32);
+  nodeHandle_.param("scheduler/statistics_period", statisticsPeriod_, 10.0);
+  batchPolicy.capacity = std::max(1, batchQueueSize);
+  scheduler_.setPolicy(FrameClass::Live, livePolicy);
+  scheduler_.setPolicy(FrameClass::Goal, goalPolicy);
+  scheduler_.setPolicy(FrameClass::Batch, batchPolicy);
+
   nodeHandle_.param("publishers/object_detector/topic", objectDetectorTopicName,
                     std::string("found_object"));
   nodeHandle_.param("publishers/object_detector/queue_size", objectDetectorQueueSize, 1);
@@ -176,18 +335,45 @@ void YoloObjectDetector::init()
                     std::string("detection_image"));
   nodeHandle_.param("publishers/detection_image/queue_size", detectionImageQueueSize, 1);
   nodeHandle_.param("publishers/detection_image/latch", detectionImageLatch, true);
+  nodeHandle_.param("publishers/change_driven/enable", changeDriven_, false);
+  nodeHandle_.param("publishers/change_driven/min_overlap", changeMinOverlap_, 0.9);
+  nodeHandle_.param("publishers/change_driven/score_delta", changeScoreDelta_, 0.1);
+  nodeHandle_.param("publishers/change_driven/keep_alive", keepAlive_, 1.0);
+  nodeHandle_.param("publishers/heartbeat/topic", heartbeatTopicName, std::string("heartbeat"));
+  nodeHandle_.param("publishers/heartbeat/queue_size", heartbeatQueueSize, 1);
 
   if(ns.length() > 0) {
     cameraTopicName         = "/" + ns + "/" + cameraTopicName;
     objectDetectorTopicName = "/" + ns + "/" + objectDetectorTopicName;
     boundingBoxesTopicName  = "/" + ns + "/" + boundingBoxesTopicName;
     detectionImageTopicName = "/" + ns + "/" + detectionImageTopicName;
+    heartbeatTopicName      = "/" + ns + "/" + heartbeatTopicName;
   }
 
-  imageSubscriber_.subscribe(imageTransport_, cameraTopicName, cameraQueueSize);                                       
-  dmapSubscriber_.subscribe(imageTransport_, dmapTopicName, dmapQueueSize);
-  imgSync_.connectInput(imageSubscriber_, dmapSubscriber_);
-  imgSync_.registerCallback(boost::bind(&YoloObjectDetector::zedCameraCallback, this, _1, _2));
+  // Camera frames and actions are served from their own callback queues, so a burst on one
+  // of them never delays the other. Images and depth maps share a queue: the synchronizer
+  // joining them runs the frame callback on whichever subscription completes a pair, so
+  // separate queues would not keep the work apart. Publisher bookkeeping stays on the global
+  // queue spun by the node.
+  cameraNodeHandle_ = nodeHandle_;
+  cameraNodeHandle_.setCallbackQueue(&cameraQueue_);
+  actionNodeHandle_ = nodeHandle_;
+  actionNodeHandle_.setCallbackQueue(&actionQueue_);
+  image_transport::ImageTransport cameraTransport(cameraNodeHandle_);
+
+  dmapSubscriber_.subscribe(cameraTransport, dmapTopicName, dmapQueueSize);
+  if (compressedInput_) {
+    // JPEG frames are decoded on the task scheduler, reduced to about the network input size.
+    compressedSubscriber_.subscribe(cameraNodeHandle_, cameraTopicName + "/compressed", cameraQueueSize);
+    compressedSync_.reset(new message_filters::Synchronizer<CompressedApproxTimePolicy>(
+        CompressedApproxTimePolicy(3), compressedSubscriber_, dmapSubscriber_));
+    compressedSync_->registerCallback(
+        boost::bind(&YoloObjectDetector::compressedCameraCallback, this, _1, _2));
+  } else {
+    imageSubscriber_.subscribe(cameraTransport, cameraTopicName, cameraQueueSize);
+    imgSync_.connectInput(imageSubscriber_, dmapSubscriber_);
+    imgSync_.registerCallback(boost::bind(&YoloObjectDetector::zedCameraCallback, this, _1, _2));
+  }
   
   objectPublisher_ = nodeHandle_.advertise<std_msgs::Int8>
       (objectDetectorTopicName, objectDetectorQueueSize, objectDetectorLatch);
@@ -195,20 +381,42 @@ void YoloObjectDetector::init()
       (boundingBoxesTopicName, boundingBoxesQueueSize, boundingBoxesLatch);
   detectionImagePublisher_ = imageTransport_.advertise
       (detectionImageTopicName, detectionImageQueueSize);
+  if (changeDriven_) {
+    heartbeatPublisher_ = nodeHandle_.advertise<std_msgs::Header>(heartbeatTopicName, heartbeatQueueSize, false);
+  }
 
-  ROS_INFO("Waiting for images in topic: %s", imageSubscriber_.getTopic().c_str());
+  ROS_INFO("Waiting for images in topic: %s",
+           compressedInput_ ? compressedSubscriber_.getTopic().c_str() : imageSubscriber_.getTopic().c_str());
 
   // Action servers.
   std::string checkForObjectsActionName;
   nodeHandle_.param("actions/camera_reading/topic", checkForObjectsActionName,
                     std::string("check_for_objects"));
   checkForObjectsActionServer_.reset(
-      new CheckForObjectsActionServer(nodeHandle_, checkForObjectsActionName, false));
+      new CheckForObjectsActionServer(actionNodeHandle_, checkForObjectsActionName, false));
   checkForObjectsActionServer_->registerGoalCallback(
       boost::bind(&YoloObjectDetector::checkForObjectsActionGoalCB, this));
   checkForObjectsActionServer_->registerPreemptCallback(
       boost::bind(&YoloObjectDetector::checkForObjectsActionPreemptCB, this));
   checkForObjectsActionServer_->start();
+
+  std::string checkForObjectsBatchName;
+  nodeHandle_.param("actions/batch_reading/topic", checkForObjectsBatchName,
+                    std::string("check_for_objects_batch"));
+  checkForObjectsBatchServer_.reset(new CheckForObjectsBatchServer(
+      actionNodeHandle_, checkForObjectsBatchName,
+      boost::bind(&YoloObjectDetector::checkForObjectsBatchGoalCB, this, _1),
+      boost::bind(&YoloObjectDetector::checkForObjectsBatchCancelCB, this, _1), false));
+  checkForObjectsBatchServer_->start();
+
+  const struct {
+    int threads;
+    ros::CallbackQueue *queue;
+  } queues[] = {{cameraThreads, &cameraQueue_}, {actionThreads, &actionQueue_}};
+  for (const auto& entry : queues) {
+    spinners_.push_back(std::make_shared<ros::AsyncSpinner>(std::max(1, entry.threads), entry.queue));
+    spinners_.back()->start();
+  }
 }
 
 void YoloObjectDetector::zedCameraCallback(const sensor_msgs::ImageConstPtr& img_msg,
@@ -216,32 +424,132 @@ void YoloObjectDetector::zedCameraCallback(const sensor_msgs::ImageConstPtr& img
 {
   ROS_DEBUG("[YoloObjectDetector] USB image received.");
 
-  cv_bridge::CvImagePtr cam_image, cam_dmap;
+  if (isStale(img_msg->header, &staleAtAdmission_)) return;
+
+  // The image stays in its native encoding and is converted while it is letterboxed.
+  // Depth is only read at a few points per box, it stays in its native encoding too.
+  CameraFrame frame;
+  DepthFrame depth;
 
   try {
-    cam_image = cv_bridge::toCvCopy(img_msg, sensor_msgs::image_encodings::BGR8);
-    cam_dmap = cv_bridge::toCvCopy(dmap_msg, sensor_msgs::image_encodings::TYPE_32FC1);
+    frame = cameraFrame(*img_msg, img_msg);
+    depth = depthFrame(dmap_msg);
   } catch (cv_bridge::Exception& e) {
     ROS_ERROR("cv_bridge exception: %s", e.what());
     return;
   }
 
-  if (cam_image && cam_dmap) {
-    {
-      boost::unique_lock<boost::shared_mutex> lockImageCallback(mutexImageCallback_);
-      imageHeader_ = img_msg->header;
-      camImageCopy_ = cam_image->image.clone();
-      camDmapCopy_ = cam_dmap->image.clone();
+  if (depth.data) {
+    ScheduledFrame scheduled;
+    scheduled.image = frame;
+    scheduled.depth = depth;
+    scheduled.header = img_msg->header;
+    scheduled.fullWidth = frame.width;
+    scheduled.fullHeight = frame.height;
+    scheduler_.push(scheduled);
+  }
+  return;
+}
+
+void YoloObjectDetector::compressedCameraCallback(const sensor_msgs::CompressedImageConstPtr& img_msg,
+                                                  const sensor_msgs::ImageConstPtr& dmap_msg)
+{
+  ROS_DEBUG("[YoloObjectDetector] Compressed image received.");
+
+  if (isStale(img_msg->header, &staleAtAdmission_)) return;
+
+  {
+    // At most decodeThreads_ frames decode at once and as many wait; newer frames win.
+    std::lock_guard<std::mutex> lock(mutexDecodes_);
+    if ((int) pendingDecodes_.size() >= std::max(1, decodeThreads_)) {
+      pendingDecodes_.pop_front();
+      ROS_DEBUG("[YoloObjectDetector] Decoders busy, dropped the oldest waiting frame.");
     }
-    {
-      boost::unique_lock<boost::shared_mutex> lockImageStatus(mutexImageStatus_);
-      imageStatus_ = true;
+    pendingDecodes_.push_back(std::make_pair(img_msg, dmap_msg));
+    if (runningDecodes_ >= std::max(1, decodeThreads_)) return;
+    ++runningDecodes_;
+  }
+  taskScheduler_->submit([this] { decodeNextFrame(); });
+}
+
+void YoloObjectDetector::decodeNextFrame()
+{
+  std::pair<sensor_msgs::CompressedImageConstPtr, sensor_msgs::ImageConstPtr> next;
+  {
+    std::lock_guard<std::mutex> lock(mutexDecodes_);
+    if (pendingDecodes_.empty()) {
+      --runningDecodes_;
+      return;
     }
-    frameWidth_ = cam_image->image.size().width;
-    frameHeight_ = cam_image->image.size().height;
-    sem_post(&sem_new_image_);
+    next = pendingDecodes_.front();
+    pendingDecodes_.pop_front();
   }
-  return;
+  decodeCompressedFrame(next.first, next.second);
+
+  {
+    std::lock_guard<std::mutex> lock(mutexDecodes_);
+    if (pendingDecodes_.empty()) {
+      --runningDecodes_;
+      return;
+    }
+  }
+  taskScheduler_->submit([this] { decodeNextFrame(); });
+}
+
+void YoloObjectDetector::decodeCompressedFrame(const sensor_msgs::CompressedImageConstPtr& img_msg,
+                                               const sensor_msgs::ImageConstPtr& dmap_msg)
+{
+  cv::Mat image;
+  int fullWidth;
+  int fullHeight;
+  if (!JpegDecoder::decode(img_msg->data.data(), img_msg->data.size(), backend_->inputWidth(),
+                           backend_->inputHeight(), &image,
+                           &fullWidth, &fullHeight)) {
+    // Other formats (e.g. png) can not be decoded reduced.
+    image = cv::imdecode(cv::Mat(img_msg->data), cv::IMREAD_COLOR);
+    if (image.empty()) {
+      ROS_ERROR("[YoloObjectDetector] Could not decode %s image.", img_msg->format.c_str());
+      return;
+    }
+    fullWidth = image.cols;
+    fullHeight = image.rows;
+  }
+
+  DepthFrame depth;
+  try {
+    depth = depthFrame(dmap_msg);
+  } catch (cv_bridge::Exception& e) {
+    ROS_ERROR("cv_bridge exception: %s", e.what());
+    return;
+  }
+
+  ScheduledFrame scheduled;
+  scheduled.image = cameraFrame(image);
+  scheduled.depth = depth;
+  scheduled.header = img_msg->header;
+  // Boxes are reported in pixels of the original image.
+  scheduled.fullWidth = fullWidth;
+  scheduled.fullHeight = fullHeight;
+
+  boost::unique_lock<boost::shared_mutex> lockImageCallback(mutexImageCallback_);
+  // Decoders can finish out of order; never go back to an older frame.
+  if (img_msg->header.stamp < imageHeader_.stamp) return;
+  imageHeader_ = img_msg->header;
+  scheduler_.push(scheduled);
+}
+
+bool YoloObjectDetector::isStale(const std_msgs::Header& header, std::atomic<unsigned long> *counter)
+{
+  // Frames without a stamp (e.g. action goals) are never stale.
+  if (maxFrameAge_ <= 0 || header.stamp.isZero()) return false;
+  const double age = (ros::Time::now() - header.stamp).toSec();
+  if (age <= maxFrameAge_) return false;
+
+  ++*counter;
+  ROS_DEBUG("[YoloObjectDetector] Dropped frame of age %.3f s.", age);
+  ROS_WARN_THROTTLE(5, "[YoloObjectDetector] Frames older than %.3f s dropped: %lu at admission, %lu before inference.",
+                    maxFrameAge_, staleAtAdmission_.load(), staleBeforeInference_.load());
+  return true;
 }
 
 void YoloObjectDetector::checkForObjectsActionGoalCB()  // TODO: fix this, adding zed support
@@ -250,40 +558,126 @@ void YoloObjectDetector::checkForObjectsActionGoalCB()  // TODO: fix this, addin
 
   boost::shared_ptr<const darknet_ros_msgs::CheckForObjectsGoal> imageActionPtr =
       checkForObjectsActionServer_->acceptNewGoal();
-  sensor_msgs::Image imageAction = imageActionPtr->image;
+  ScheduledFrame scheduled;
 
-  cv_bridge::CvImagePtr cam_image;
+  try {
+    scheduled.image = cameraFrame(imageActionPtr->image, imageActionPtr);
+  } catch (cv_bridge::Exception& e) {
+    ROS_ERROR("cv_bridge exception: %s", e.what());
+    checkForObjectsActionServer_->setAborted(darknet_ros_msgs::CheckForObjectsResult(), e.what());
+    return;
+  }
+
+  // The accepted goal replaced the previous one, whose frame need not run any more.
+  scheduler_.clear(FrameClass::Goal);
+  scheduled.header = imageActionPtr->image.header;
+  scheduled.frameClass = FrameClass::Goal;
+  scheduled.fullWidth = scheduled.image.width;
+  scheduled.fullHeight = scheduled.image.height;
+  scheduled.ticket = ++nextTicket_;
+  scheduled.actionId = imageActionPtr->id;
+  goalTicket_ = scheduled.ticket;
+  scheduler_.push(scheduled);
+  return;
+}
+
+void YoloObjectDetector::checkForObjectsActionPreemptCB()
+{
+  ROS_DEBUG("[YoloObjectDetector] Preempt check for objects action.");
+  scheduler_.clear(FrameClass::Goal);
+  checkForObjectsActionServer_->setPreempted();
+}
+
+void YoloObjectDetector::checkForObjectsBatchGoalCB(CheckForObjectsBatchGoal goal)
+{
+  ROS_DEBUG("[YoloObjectDetector] Batch check for objects goal received.");
+
+  boost::shared_ptr<const darknet_ros_msgs::CheckForObjectsGoal> imageActionPtr = goal.getGoal();
+  ScheduledFrame scheduled;
 
   try {
-    cam_image = cv_bridge::toCvCopy(imageAction, sensor_msgs::image_encodings::BGR8);
+    scheduled.image = cameraFrame(imageActionPtr->image, imageActionPtr);
   } catch (cv_bridge::Exception& e) {
     ROS_ERROR("cv_bridge exception: %s", e.what());
+    goal.setRejected(darknet_ros_msgs::CheckForObjectsResult(), e.what());
     return;
   }
 
-  if (cam_image) {
+  scheduled.header = imageActionPtr->image.header;
+  scheduled.frameClass = FrameClass::Batch;
+  scheduled.fullWidth = scheduled.image.width;
+  scheduled.fullHeight = scheduled.image.height;
+  scheduled.ticket = ++nextTicket_;
+  scheduled.actionId = imageActionPtr->id;
+
+  // The goal is registered first, its frame may be done before this callback returns.
+  {
+    boost::unique_lock<boost::shared_mutex> lockBatchGoals(mutexBatchGoals_);
+    batchGoals_[scheduled.ticket] = goal;
+  }
+  goal.setAccepted();
+  if (!scheduler_.push(scheduled)) {
     {
-      boost::unique_lock<boost::shared_mutex> lockImageCallback(mutexImageCallback_);
-      camImageCopy_ = cam_image->image.clone();
+      boost::unique_lock<boost::shared_mutex> lockBatchGoals(mutexBatchGoals_);
+      batchGoals_.erase(scheduled.ticket);
     }
-    {
-      boost::unique_lock<boost::shared_mutex> lockImageCallback(mutexActionStatus_);
-      actionId_ = imageActionPtr->id;
+    goal.setAborted(darknet_ros_msgs::CheckForObjectsResult(), "Batch queue is full.");
+  }
+}
+
+void YoloObjectDetector::checkForObjectsBatchCancelCB(CheckForObjectsBatchGoal goal)
+{
+  ROS_DEBUG("[YoloObjectDetector] Cancel batch check for objects goal.");
+  {
+    boost::unique_lock<boost::shared_mutex> lockBatchGoals(mutexBatchGoals_);
+    for (auto it = batchGoals_.begin(); it != batchGoals_.end(); ++it) {
+      if (it->second == goal) {
+        // Its frame still runs if it is queued, the result is discarded.
+        batchGoals_.erase(it);
+        break;
+      }
     }
-    {
-      boost::unique_lock<boost::shared_mutex> lockImageStatus(mutexImageStatus_);
-      imageStatus_ = true;
+  }
+  goal.setCanceled();
+}
+
+void YoloObjectDetector::sendActionResult(const ScheduledFrame& frame,
+                                          const darknet_ros_msgs::CheckForObjectsResult& result)
+{
+  if (frame.frameClass == FrameClass::Goal) {
+    // A newer goal or a preemption supersedes the frame.
+    if (frame.ticket == goalTicket_ && isCheckingForObjects()) {
+      checkForObjectsActionServer_->setSucceeded(result, "Send bounding boxes.");
     }
-    frameWidth_ = cam_image->image.size().width;
-    frameHeight_ = cam_image->image.size().height;
+    return;
   }
-  return;
+
+  CheckForObjectsBatchGoal goal;
+  {
+    boost::unique_lock<boost::shared_mutex> lockBatchGoals(mutexBatchGoals_);
+    auto it = batchGoals_.find(frame.ticket);
+    if (it == batchGoals_.end()) return;
+    goal = it->second;
+    batchGoals_.erase(it);
+  }
+  goal.setSucceeded(result, "Send bounding boxes.");
 }
 
-void YoloObjectDetector::checkForObjectsActionPreemptCB()
+void YoloObjectDetector::reportQueueingDelays()
 {
-  ROS_DEBUG("[YoloObjectDetector] Preempt check for objects action.");
-  checkForObjectsActionServer_->setPreempted();
+  const double now = what_time_is_it_now();
+  if (statisticsPeriod_ <= 0 || now - lastStatistics_ < statisticsPeriod_) return;
+  lastStatistics_ = now;
+
+  const char *names[] = {"live", "goal", "batch"};
+  const FrameClass classes[] = {FrameClass::Live, FrameClass::Goal, FrameClass::Batch};
+  for (int i = 0; i < 3; ++i) {
+    FrameScheduler::Statistics statistics = scheduler_.collectStatistics(classes[i]);
+    if (statistics.dispatched == 0 && statistics.dropped == 0) continue;
+    ROS_INFO("[YoloObjectDetector] Queueing delay of %s frames: %.1f ms mean, %.1f ms max over %lu frames, %lu dropped.",
+             names[i], 1000 * statistics.meanDelay, 1000 * statistics.maxDelay, statistics.dispatched,
+             statistics.dropped);
+  }
 }
 
 bool YoloObjectDetector::isCheckingForObjects() const
@@ -306,52 +700,66 @@ bool YoloObjectDetector::publishDetectionImage(const cv::Mat& detectionImage)
   return true;
 }
 
-int YoloObjectDetector::sizeNetwork(network *net)
+int YoloObjectDetector::sizeNetwork()
 {
-  int i;
   int count = 0;
-  for(i = 0; i < net->n; ++i){
-    layer l = net->layers[i];
-    if(l.type == YOLO || l.type == REGION || l.type == DETECTION){
-      count += l.outputs;
-    }
+  for (const DetectionHead& head : backend_->heads()) {
+    count += head.size;
   }
   return count;
 }
 
-void YoloObjectDetector::rememberNetwork(network *net)
+void YoloObjectDetector::rememberNetwork()
 {
-  int i;
   int count = 0;
-  for(i = 0; i < net->n; ++i){
-    layer l = net->layers[i];
-    if(l.type == YOLO || l.type == REGION || l.type == DETECTION){
-      memcpy(predictions_[demoIndex_] + count, net->layers[i].output, sizeof(float) * l.outputs);
-      count += l.outputs;
-    }
+  for (const DetectionHead& head : backend_->heads()) {
+    memcpy(predictions_[demoIndex_] + count, head.output, sizeof(float) * head.size);
+    count += head.size;
   }
 }
 
-detection *YoloObjectDetector::avgPredictions(network *net, int *nboxes)
+detection *YoloObjectDetector::avgPredictions(int width, int height, int *nboxes)
 {
-  int i, j;
+  int j;
   int count = 0;
   fill_cpu(demoTotal_, 0, avg_, 1);
   for(j = 0; j < demoFrame_; ++j){
     axpy_cpu(demoTotal_, 1./demoFrame_, predictions_[j], 1, avg_, 1);
   }
-  for(i = 0; i < net->n; ++i){
-    layer l = net->layers[i];
-    if(l.type == YOLO || l.type == REGION || l.type == DETECTION){
-      memcpy(l.output, avg_ + count, sizeof(float) * l.outputs);
-      count += l.outputs;
-    }
+  for (const DetectionHead& head : backend_->heads()) {
+    memcpy(head.output, avg_ + count, sizeof(float) * head.size);
+    count += head.size;
   }
-  detection *dets = get_network_boxes(net, buff_[0].w, buff_[0].h, demoThresh_, demoHier_, 0, 1, nboxes);
+  detection *dets = backend_->detections(primaryHeads_, width, height, demoThresh_, demoHier_, nboxes);
   return dets;
 }
 
-float YoloObjectDetector::getObjDepth(float xmin, float xmax, float ymin, float ymax)
+detection *YoloObjectDetector::trackDetections(detection *dets, int *nboxes)
+{
+  std::vector<TrackedBox> boxes;
+  for (int i = 0; i < *nboxes; ++i) {
+    for (int j = 0; j < primaryClasses_; ++j) {
+      if (dets[i].prob[j] > 0) boxes.push_back({dets[i].bbox, j, dets[i].prob[j]});
+    }
+  }
+  free_detections(dets, *nboxes);
+
+  boxTracker_->update(&boxes, demoThresh_);
+
+  // One detection per track, laid out as darknet's so drawing and publishing stay the same.
+  *nboxes = boxes.size();
+  detection *tracked = (detection *) calloc(boxes.size(), sizeof(detection));
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    tracked[i].bbox = boxes[i].bbox;
+    tracked[i].classes = primaryClasses_;
+    tracked[i].objectness = boxes[i].prob;
+    tracked[i].prob = (float *) calloc(primaryClasses_, sizeof(float));
+    tracked[i].prob[boxes[i].classId] = boxes[i].prob;
+  }
+  return tracked;
+}
+
+float YoloObjectDetector::getObjDepth(const DepthFrame& depth, float xmin, float xmax, float ymin, float ymax)
 {
   /* Given the bounding box, read the depth from 9 internal points. Sort them, then take the second minimum.
    * This is possibly better than taking the minimum as it may be a spurious outlier, for some reason. */
@@ -363,7 +771,7 @@ float YoloObjectDetector::getObjDepth(float xmin, float xmax, float ymin, float
     for (int j=1; j < refs+1; ++j) {
       x = xmin + j*(xmax-xmin)/(refs+1);
       y = ymin + i*(ymax-ymin)/(refs+1);
-      d = camDmapCopy_.at<float>((int)(y*frameHeight_), (int)(x*frameWidth_));
+      d = depth.metres((int)(x*depth.width), (int)(y*depth.height));
       if (std::isnormal(d))
         depths.push_back(d);
     }
@@ -380,21 +788,318 @@ float YoloObjectDetector::getObjDepth(float xmin, float xmax, float ymin, float
   } else return NAN; 
 }
 
+void YoloObjectDetector::setupHeadSets()
+{
+  const std::vector<DetectionHead>& heads = backend_->heads();
+  std::vector<bool> taken(heads.size(), false);
+  std::vector<std::string> names;
+  std::string ns;
+  nodeHandle_.param("yolo_model/head_sets/names", names, std::vector<std::string>(0));
+  nodeHandle_.getParam("namespace", ns);
+
+  for (const std::string& name : names) {
+    const std::string prefix = "yolo_model/head_sets/" + name;
+    HeadSet set;
+    set.name = name;
+    std::vector<int> indices;
+    nodeHandle_.param(prefix + "/heads", indices, std::vector<int>(0));
+    for (int head : indices) {
+      if (head < 0 || head >= (int) heads.size() || taken[head]) {
+        ROS_WARN("[YoloObjectDetector] Head %d of head set %s does not exist or is taken.", head, name.c_str());
+        continue;
+      }
+      if (!set.heads.empty() && heads[head].classes != set.classes) {
+        ROS_WARN("[YoloObjectDetector] Head %d of head set %s has other classes, ignored.", head, name.c_str());
+        continue;
+      }
+      taken[head] = true;
+      set.heads.push_back(head);
+      set.classes = heads[head].classes;
+    }
+    if (set.heads.empty()) {
+      ROS_WARN("[YoloObjectDetector] Head set %s has no detection heads, ignored.", name.c_str());
+      continue;
+    }
+
+    std::string topic;
+    int queueSize;
+    bool latch;
+    nodeHandle_.param(prefix + "/detection_classes/names", set.classLabels, std::vector<std::string>(0));
+    nodeHandle_.param(prefix + "/topic", topic, name + "/bounding_boxes");
+    nodeHandle_.param(prefix + "/queue_size", queueSize, 1);
+    nodeHandle_.param(prefix + "/latch", latch, false);
+    if (ns.length() > 0) {
+      topic = "/" + ns + "/" + topic;
+    }
+    set.publisher = nodeHandle_.advertise<darknet_ros_msgs::BoundingBoxes>(topic, queueSize, latch);
+    ROS_INFO("[YoloObjectDetector] Head set %s: %d heads, %d classes on %s.", name.c_str(), (int) set.heads.size(),
+             set.classes, topic.c_str());
+    headSets_.push_back(set);
+  }
+
+  // The main topics and actions get the remaining heads.
+  primaryHeads_ = mainDetectionHeads(heads, taken);
+  primaryClasses_ = primaryHeads_.empty() ? 0 : heads[primaryHeads_.front()].classes;
+  for (int i = 0; i < (int) heads.size(); ++i) {
+    if (!taken[i] && heads[i].classes != primaryClasses_) {
+      ROS_WARN("[YoloObjectDetector] Head %d has other classes than the main heads, ignored.", i);
+    }
+  }
+
+  // The main topics index the class names with the classes of these heads.
+  if (primaryHeads_.empty()) {
+    ROS_FATAL("[YoloObjectDetector] No detection heads are left for the main topics.");
+    exit(EXIT_FAILURE);
+  }
+  if (primaryClasses_ != numClasses_) {
+    ROS_FATAL("[YoloObjectDetector] The main detection heads have %d classes, yolo_model/detection_classes/names "
+              "has %d.", primaryClasses_, numClasses_);
+    exit(EXIT_FAILURE);
+  }
+}
+
+void YoloObjectDetector::setupHeadTensors()
+{
+  bool enable;
+  nodeHandle_.param("publishers/head_tensors/enable", enable, false);
+  if (!enable) return;
+
+  std::string topic;
+  std::string segment;
+  int queueSize;
+  int slots;
+  nodeHandle_.param("publishers/head_tensors/topic", topic, std::string("head_tensors"));
+  nodeHandle_.param("publishers/head_tensors/queue_size", queueSize, 1);
+  nodeHandle_.param("publishers/head_tensors/segment", segment, std::string("/darknet_ros_head_tensors"));
+  nodeHandle_.param("publishers/head_tensors/slots", slots, 4);
+
+  // All heads of a frame back to back, the layout is the same for every frame.
+  size_t size = 0;
+  headTensors_.heads.clear();
+  for (const DetectionHead& head : backend_->heads()) {
+    darknet_ros_msgs::HeadTensor tensor;
+    tensor.offset = size;
+    tensor.width = head.width;
+    tensor.height = head.height;
+    tensor.anchors = head.anchors;
+    tensor.channels = head.size / head.boxes;
+    tensor.classes = head.classes;
+    headTensors_.heads.push_back(tensor);
+    size += sizeof(float) * head.size;
+  }
+
+  headTensorRing_.reset(new SharedMemoryRing(segment, HeadTensorsMagic, std::max(1, slots), size));
+  if (!headTensorRing_->valid()) {
+    ROS_ERROR("[YoloObjectDetector] Shared memory %s could not be created, head outputs are not exported.",
+              segment.c_str());
+    headTensorRing_.reset();
+    return;
+  }
+  headTensors_.header.frame_id = "detection";
+  headTensors_.segment = segment;
+  headTensorsPublisher_ = nodeHandle_.advertise<darknet_ros_msgs::HeadTensors>(topic, queueSize, false);
+  ROS_INFO("[YoloObjectDetector] Head outputs exported to %s, %d slots of %.1f MB.", segment.c_str(),
+           std::max(1, slots), size / 1048576.);
+}
+
+void YoloObjectDetector::exportHeadTensors(const ScheduledFrame& frame)
+{
+  uint32_t slot;
+  char *payload = static_cast<char *>(headTensorRing_->beginWrite(&slot));
+  size_t size = 0;
+  for (const DetectionHead& head : backend_->heads()) {
+    memcpy(payload + size, head.output, sizeof(float) * head.size);
+    size += sizeof(float) * head.size;
+  }
+  const uint64_t sequence = headTensorRing_->commit(frame.header.stamp.toNSec(), size);
+
+  headTensors_.header.stamp = ros::Time::now();
+  headTensors_.image_header = frame.header;
+  headTensors_.slot = slot;
+  headTensors_.sequence = sequence;
+  headTensors_.offset = headTensorRing_->payloadOffset(slot);
+  headTensorsPublisher_.publish(headTensors_);
+}
+
+void YoloObjectDetector::setupDetectionRing()
+{
+  bool enable;
+  nodeHandle_.param("publishers/shared_detections/enable", enable, false);
+  if (!enable) return;
+
+  std::string segment;
+  int slots;
+  nodeHandle_.param("publishers/shared_detections/segment", segment, std::string("/darknet_ros_detections"));
+  nodeHandle_.param("publishers/shared_detections/slots", slots, 8);
+  nodeHandle_.param("publishers/shared_detections/capacity", detectionRingCapacity_, 256);
+  detectionRingCapacity_ = std::max(1, detectionRingCapacity_);
+
+  detectionRing_.reset(new SharedMemoryRing(segment, DetectionsMagic, std::max(1, slots),
+                                            sizeof(SharedDetections) +
+                                                detectionRingCapacity_ * sizeof(SharedDetection)));
+  if (!detectionRing_->valid()) {
+    ROS_ERROR("[YoloObjectDetector] Shared memory %s could not be created, detections are not shared.",
+              segment.c_str());
+    detectionRing_.reset();
+    return;
+  }
+  ROS_INFO("[YoloObjectDetector] Detections shared in %s, %d slots of %d objects.", segment.c_str(),
+           std::max(1, slots), detectionRingCapacity_);
+}
+
+void YoloObjectDetector::writeDetectionRing(const ScheduledFrame& frame, const RosBox_ *boxes, int num)
+{
+  uint32_t slot;
+  char *payload = static_cast<char *>(detectionRing_->beginWrite(&slot));
+  SharedDetections *detections = reinterpret_cast<SharedDetections *>(payload);
+  SharedDetection *objects = reinterpret_cast<SharedDetection *>(payload + sizeof(SharedDetections));
+
+  const int count = std::min(num, detectionRingCapacity_);
+  for (int i = 0; i < count; ++i) {
+    const RosBox_& roi = boxes[i];
+    SharedDetection& object = objects[i];
+    object.xmin = (roi.x - roi.w / 2) * frame.fullWidth;
+    object.ymin = (roi.y - roi.h / 2) * frame.fullHeight;
+    object.xmax = (roi.x + roi.w / 2) * frame.fullWidth;
+    object.ymax = (roi.y + roi.h / 2) * frame.fullHeight;
+    object.probability = roi.prob;
+    // getObjDepth gives NaN without a valid depth reading.
+    object.depth = std::isnan(roi.z) ? 0 : roi.z;
+    object.classId = roi.Class;
+    object.reserved = 0;
+    const char *label = roi.Class < (int) classLabels_.size() ? classLabels_[roi.Class].c_str() : "";
+    strncpy(object.label, label, sizeof(object.label) - 1);
+    object.label[sizeof(object.label) - 1] = 0;
+  }
+  detections->imageStamp = frame.header.stamp.toNSec();
+  detections->imageSeq = frame.header.seq;
+  detections->count = count;
+  strncpy(detections->frameId, frame.header.frame_id.c_str(), sizeof(detections->frameId) - 1);
+  detections->frameId[sizeof(detections->frameId) - 1] = 0;
+
+  detectionRing_->commit(detections->imageStamp, sizeof(SharedDetections) + count * sizeof(SharedDetection));
+}
+
+bool YoloObjectDetector::detectionsChanged()
+{
+  const ros::Time now = ros::Time::now();
+  bool changed = boundingBoxesResults_.count() != publishedBoxes_.size() ||
+                 (now - lastFullPublish_).toSec() >= keepAlive_;
+
+  // Every box has to continue a distinct published box of its class.
+  std::vector<bool> matched(publishedBoxes_.size(), false);
+  for (size_t i = 0; i < boundingBoxesResults_.count() && !changed; ++i) {
+    const darknet_ros_msgs::BoundingBox& box = boundingBoxesResults_[i];
+    size_t j = 0;
+    for (; j < publishedBoxes_.size(); ++j) {
+      const darknet_ros_msgs::BoundingBox& published = publishedBoxes_[j];
+      if (matched[j] || published.Class != box.Class ||
+          std::abs(published.probability - box.probability) > changeScoreDelta_) {
+        continue;
+      }
+      const double width = std::min(box.xmax, published.xmax) - std::max(box.xmin, published.xmin);
+      const double height = std::min(box.ymax, published.ymax) - std::max(box.ymin, published.ymin);
+      const double intersection = width > 0 && height > 0 ? width * height : 0;
+      const double areas = (double) (box.xmax - box.xmin) * (box.ymax - box.ymin) +
+                           (double) (published.xmax - published.xmin) * (published.ymax - published.ymin);
+      if (intersection >= changeMinOverlap_ * (areas - intersection)) break;
+    }
+    if (j == publishedBoxes_.size()) {
+      changed = true;
+    } else {
+      matched[j] = true;
+    }
+  }
+  if (!changed) return false;
+
+  publishedBoxes_.resize(boundingBoxesResults_.count());
+  for (size_t i = 0; i < boundingBoxesResults_.count(); ++i) {
+    publishedBoxes_[i] = boundingBoxesResults_[i];
+  }
+  lastFullPublish_ = now;
+  return true;
+}
+
+void YoloObjectDetector::detectHeadSet(HeadSet& set, const ScheduledFrame& frame, int slot)
+{
+  int nboxes = 0;
+  detection *dets = backend_->detections(set.heads, frame.image.width, frame.image.height, demoThresh_, demoHier_,
+                                         &nboxes);
+  suppressDetections(dets, nboxes, set.classes);
+  collectFrameBoxes(dets, nboxes, set.classes, &set.boxes);
+
+  darknet_ros_msgs::BoundingBoxes& results = set.results[slot];
+  results.bounding_boxes.clear();
+  for (const FrameBox& frameBox : set.boxes) {
+    darknet_ros_msgs::BoundingBox boundingBox;
+    const int classId = frameBox.classId;
+    boundingBox.Class = classId < (int) set.classLabels.size() ? set.classLabels[classId] : std::to_string(classId);
+    boundingBox.probability = frameBox.probability;
+    boundingBox.xmin = frameBox.xmin * frame.fullWidth;
+    boundingBox.ymin = frameBox.ymin * frame.fullHeight;
+    boundingBox.xmax = frameBox.xmax * frame.fullWidth;
+    boundingBox.ymax = frameBox.ymax * frame.fullHeight;
+    boundingBox.z = getObjDepth(frame.depth, frameBox.xmin, frameBox.xmax, frameBox.ymin, frameBox.ymax);
+    results.bounding_boxes.push_back(boundingBox);
+  }
+  results.image_header = frame.header;
+  results.header.stamp = frame.header.stamp;
+  results.header.frame_id = "detection";
+  free_detections(dets, nboxes);
+}
+
 void *YoloObjectDetector::detectInThread()
 {
   running_ = 1;
-  float nms = .4;
 
-  layer l = net_->layers[net_->n - 1];
+  // A live frame that aged past the budget while waiting is not worth the forward pass.
+  const int slot = (buffIndex_ + 2) % 3;
+  const ScheduledFrame& frame = buffFrame_[slot];
+  if (buffValid_[slot] && frame.frameClass == FrameClass::Live) {
+    buffValid_[slot] = !isStale(frame.header, &staleBeforeInference_);
+  }
+  if (!buffValid_[slot]) {
+    running_ = 0;
+    return 0;
+  }
+
   float *X = buffLetter_[(buffIndex_ + 2) % 3].data;
-  float *prediction = network_predict(net_, X);
+  backend_->run(X);
+
+  // Before averaging overwrites the outputs of this frame.
+  if (headTensorRing_ && frame.frameClass == FrameClass::Live) {
+    exportHeadTensors(frame);
+  }
 
-  rememberNetwork(net_);
   detection *dets = 0;
   int nboxes = 0;
-  dets = avgPredictions(net_, &nboxes);
+  // Letterbox correction depends on the size of this frame, action goals come in any size.
+  // Only the live stream is averaged; goals are decoded on their own and stay out of its history.
+  const bool averaged = demoFrame_ > 1 && frame.frameClass == FrameClass::Live;
+  if (averaged) {
+    rememberNetwork();
+    dets = avgPredictions(frame.image.width, frame.image.height, &nboxes);
+  } else {
+    dets = backend_->detections(primaryHeads_, frame.image.width, frame.image.height, demoThresh_, demoHier_,
+                                &nboxes);
+  }
+
+  suppressDetections(dets, nboxes, primaryClasses_);
 
-  if (nms > 0) do_nms_obj(dets, nboxes, l.classes, nms);
+  // Only the live stream is continuous in time.
+  if (boxTracker_ && frame.frameClass == FrameClass::Live) {
+    dets = trackDetections(dets, &nboxes);
+  }
+
+  // Head sets decode their own heads of the same forward pass meanwhile. They are only
+  // published for the live stream, action goals and batch frames skip them.
+  TaskGroup headSets(*taskScheduler_, TaskPriority::Critical);
+  if (frame.frameClass == FrameClass::Live) {
+    for (HeadSet& set : headSets_) {
+      HeadSet *target = &set;
+      headSets.run([this, target, &frame, slot] { detectHeadSet(*target, frame, slot); });
+    }
+  }
 
   if (enableConsoleOutput_) {
     printf("\033[2J");
@@ -404,80 +1109,58 @@ void *YoloObjectDetector::detectInThread()
     printf("Objects:\n\n");
   }
   image display = buff_[(buffIndex_+2) % 3];
-  draw_detections(display, dets, nboxes, demoThresh_, demoNames_, demoAlphabet_, demoClasses_);
+  draw_detections(display, dets, nboxes, demoThresh_, demoNames_, demoAlphabet_, primaryClasses_);
 
   // extract the bounding boxes and send them to ROS
-  int i, j;
+  // BoundingBox must be 1% size of frame (3.2x2.4 pixels)
+  collectFrameBoxes(dets, nboxes, primaryClasses_, &frameBoxes_);
+  RosBox_ *roiBoxes = roiBoxes_[slot];
   int count = 0;
-  for (i = 0; i < nboxes; ++i) {
-    float xmin = dets[i].bbox.x - dets[i].bbox.w / 2.;
-    float xmax = dets[i].bbox.x + dets[i].bbox.w / 2.;
-    float ymin = dets[i].bbox.y - dets[i].bbox.h / 2.;
-    float ymax = dets[i].bbox.y + dets[i].bbox.h / 2.;
-
-    if (xmin < 0)
-      xmin = 0;
-    if (ymin < 0)
-      ymin = 0;
-    if (xmax > 1)
-      xmax = 1;
-    if (ymax > 1)
-      ymax = 1;
-
-    // iterate through possible boxes and collect the bounding boxes
-    for (j = 0; j < demoClasses_; ++j) {
-      if (dets[i].prob[j]) {
-        float x_center = (xmin + xmax) / 2;
-        float y_center = (ymin + ymax) / 2;
-        float BBox_width = xmax - xmin;
-        float BBox_height = ymax - ymin;
-
-        // define bounding box
-        // BoundingBox must be 1% size of frame (3.2x2.4 pixels)
-        if (BBox_width > 0.01 && BBox_height > 0.01) {
-          roiBoxes_[count].x = x_center;
-          roiBoxes_[count].y = y_center;
-          roiBoxes_[count].w = BBox_width;
-          roiBoxes_[count].h = BBox_height;
-          roiBoxes_[count].z = getObjDepth(xmin, xmax, ymin, ymax);
-          roiBoxes_[count].Class = j;
-          roiBoxes_[count].prob = dets[i].prob[j];
-          
-          if (enableConsoleOutput_)
-            printf("at distance %4.2f m\n", roiBoxes_[count].z);
-
-          ++count;
-        }
-      }
-    }
+  for (const FrameBox& frameBox : frameBoxes_) {
+    if (count == roiBoxesCapacity_) break;
+    roiBoxes[count].x = (frameBox.xmin + frameBox.xmax) / 2;
+    roiBoxes[count].y = (frameBox.ymin + frameBox.ymax) / 2;
+    roiBoxes[count].w = frameBox.xmax - frameBox.xmin;
+    roiBoxes[count].h = frameBox.ymax - frameBox.ymin;
+    roiBoxes[count].z = getObjDepth(frame.depth, frameBox.xmin, frameBox.xmax, frameBox.ymin, frameBox.ymax);
+    roiBoxes[count].Class = frameBox.classId;
+    roiBoxes[count].prob = frameBox.probability;
+
+    if (enableConsoleOutput_)
+      printf("at distance %4.2f m\n", roiBoxes[count].z);
+
+    ++count;
   }
 
   // create array to store found bounding boxes
   // if no object detected, make sure that ROS knows that num = 0
   if (count == 0) {
-    roiBoxes_[0].num = 0;
+    roiBoxes[0].num = 0;
   } else {
-    roiBoxes_[0].num = count;
+    roiBoxes[0].num = count;
   }
 
   free_detections(dets, nboxes);
-  demoIndex_ = (demoIndex_ + 1) % demoFrame_;
+  headSets.wait();
+  if (averaged) demoIndex_ = (demoIndex_ + 1) % demoFrame_;
   running_ = 0;
   return 0;
 }
 
-void *YoloObjectDetector::fetchInThread()
+void *YoloObjectDetector::fetchInThread(const ScheduledFrame *frame)
 {
-  IplImageWithHeader_ imageAndHeader = getIplImageWithHeader();
-  IplImage* ROS_img = imageAndHeader.image;
-  ipl_into_image(ROS_img, buff_[buffIndex_]);
-  headerBuff_[buffIndex_] = imageAndHeader.header;
-  {
-    boost::shared_lock<boost::shared_mutex> lock(mutexImageCallback_);
-    buffId_[buffIndex_] = actionId_;
+  // Without a frame the slot stays empty while the pipeline drains.
+  buffValid_[buffIndex_] = frame != nullptr;
+  if (!frame) return 0;
+
+  buffFrame_[buffIndex_] = *frame;
+  letterboxFrame(frame->image, buffLetter_[buffIndex_]);
+
+  // The full size image is only needed to draw the detections on.
+  if (viewImage_ || demoPrefix_ || detectionImagePublisher_.getNumSubscribers() > 0) {
+    image& full = buff_[buffIndex_];
+    convertFrame(frame->image, full, full.w, full.h, 0, 0);
   }
-  rgbgr_image(buff_[buffIndex_]);
-  letterbox_image_into(buff_[buffIndex_], net_->w, net_->h, buffLetter_[buffIndex_]);
   return 0;
 }
 
@@ -486,14 +1169,10 @@ void *YoloObjectDetector::fetchInThread()
 void *YoloObjectDetector::displayInThread(void *ptr)
 {
   image p = buff_[(buffIndex_ + 1)%3];
-  std::string name = "YOLO V3";
   IplImage *disp = ipl_;
   int x,y,k;
   if(p.c == 3) rgbgr_image(p);
 
-  char buff[256];
-  sprintf(buff, "%s", name.c_str());
-
   int step = disp->widthStep;
 
   for(y = 0; y < p.h; ++y){
@@ -515,29 +1194,27 @@ void *YoloObjectDetector::displayInThread(void *ptr)
       cvResize(buffer, disp, CV_INTER_LINEAR);
       cvReleaseImage(&buffer);
   }
-  if (viewImage_) {
-      cvNamedWindow(buff, CV_WINDOW_NORMAL); 
-      cvShowImage(buff, disp);
+  // The window takes the frame on its own thread, if it is ready for one.
+  if (viewer_) {
+      viewer_->show(cv::cvarrToMat(disp));
   }
+  return 0;
+}
 
-
-  int c = cvWaitKey(waitKeyDelay_);
-  if (c != -1) c = c%256;
-  if (c == 27) {
+void YoloObjectDetector::handleKey(int key)
+{
+  // The viewer thread is the only writer, readers see either value.
+  if (key == 27) {
       demoDone_ = 1;
-      return 0;
-  } else if (c == 82) {
-      demoThresh_ += .02;
-  } else if (c == 84) {
-      demoThresh_ -= .02;
-      if(demoThresh_ <= .02) demoThresh_ = .02;
-  } else if (c == 83) {
-      demoHier_ += .02;
-  } else if (c == 81) {
-      demoHier_ -= .02;
-      if(demoHier_ <= .0) demoHier_ = .0;
+  } else if (key == 82) {
+      demoThresh_ = demoThresh_ + .02f;
+  } else if (key == 84) {
+      demoThresh_ = std::max(.02f, demoThresh_ - .02f);
+  } else if (key == 83) {
+      demoHier_ = demoHier_ + .02f;
+  } else if (key == 81) {
+      demoHier_ = std::max(0.f, demoHier_ - .02f);
   }
-  return 0;
 }
 
 void *YoloObjectDetector::displayLoop(void *ptr)
@@ -570,84 +1247,106 @@ void YoloObjectDetector::setupNetwork(char *cfgfile, char *weightfile, char *dat
   demoHier_ = hier;
   fullScreen_ = fullscreen;
   printf("YOLO V3\n");
-  net_ = load_network(cfgfile, weightfile, 0);
-  set_batch_network(net_, 1);
+  if (!backend_->load(cfgfile, weightfile)) {
+    ROS_FATAL("[YoloObjectDetector] The %s backend could not load %s.", backend_->name().c_str(), weightfile);
+    exit(EXIT_FAILURE);
+  }
 }
 
 void YoloObjectDetector::yolo()
 {
   const auto wait_duration = std::chrono::milliseconds(2000);
-  while (!getImageStatus()) {
+  ScheduledFrame frame;
+  while (!scheduler_.pop(&frame, wait_duration)) {
     printf("Waiting for image.\n");
     if (!isNodeRunning()) {
       return;
     }
-    std::this_thread::sleep_for(wait_duration);
   }
 
-  std::thread detect_thread;
-  std::thread fetch_thread;
-
   srand(2222222);
 
   int i;
-  demoTotal_ = sizeNetwork(net_);
-  predictions_ = (float **) calloc(demoFrame_, sizeof(float*));
-  for (i = 0; i < demoFrame_; ++i){
-      predictions_[i] = (float *) calloc(demoTotal_, sizeof(float));
+  demoTotal_ = sizeNetwork();
+  // A single frame is decoded straight from the head outputs.
+  if (demoFrame_ > 1) {
+    predictions_ = (float **) calloc(demoFrame_, sizeof(float*));
+    for (i = 0; i < demoFrame_; ++i){
+        predictions_[i] = (float *) calloc(demoTotal_, sizeof(float));
+    }
+    avg_ = (float *) calloc(demoTotal_, sizeof(float));
   }
-  avg_ = (float *) calloc(demoTotal_, sizeof(float));
 
-  layer l = net_->layers[net_->n - 1];
-  roiBoxes_ = (darknet_ros::RosBox_ *) calloc(l.w * l.h * l.n, sizeof(darknet_ros::RosBox_));
+  // One box per anchor of every remaining detection head.
+  roiBoxesCapacity_ = 1;
+  for (const DetectionHead& head : backend_->heads()) {
+    roiBoxesCapacity_ += head.boxes;
+  }
+  for (i = 0; i < 3; ++i) {
+    roiBoxes_[i] = (darknet_ros::RosBox_ *) calloc(roiBoxesCapacity_, sizeof(darknet_ros::RosBox_));
+  }
+  // Published boxes keep their storage, class names included, from frame to frame. Every box
+  // a frame can have is published, so the buffer never grows while running.
+  size_t labelLength = 0;
+  for (const std::string& label : classLabels_) {
+    labelLength = std::max(labelLength, label.size());
+  }
+  boundingBoxesResults_.reserve(roiBoxesCapacity_, labelLength);
+  boundingBoxesResults_.header.frame_id = "detection";
 
-  IplImageWithHeader_ imageAndHeader = getIplImageWithHeader();
-  IplImage* ROS_img = imageAndHeader.image;
-  buff_[0] = ipl_to_image(ROS_img);
+  buff_[0] = make_image(frame.image.width, frame.image.height, 3);
+  convertFrame(frame.image, buff_[0], buff_[0].w, buff_[0].h, 0, 0);
   buff_[1] = copy_image(buff_[0]);
   buff_[2] = copy_image(buff_[0]);
-  headerBuff_[0] = imageAndHeader.header;
-  headerBuff_[1] = headerBuff_[0];
-  headerBuff_[2] = headerBuff_[0];
-  buffLetter_[0] = letterbox_image(buff_[0], net_->w, net_->h);
-  buffLetter_[1] = letterbox_image(buff_[0], net_->w, net_->h);
-  buffLetter_[2] = letterbox_image(buff_[0], net_->w, net_->h);
+  buffLetter_[0] = letterbox_image(buff_[0], backend_->inputWidth(), backend_->inputHeight());
+  buffLetter_[1] = letterbox_image(buff_[0], backend_->inputWidth(), backend_->inputHeight());
+  buffLetter_[2] = letterbox_image(buff_[0], backend_->inputWidth(), backend_->inputHeight());
   ipl_ = cvCreateImage(cvSize(buff_[0].w, buff_[0].h), IPL_DEPTH_8U, buff_[0].c);
 
   int count = 0;
 
   if (!demoPrefix_ && viewImage_) {
-    cvNamedWindow("YOLO V3", CV_WINDOW_NORMAL);
-    if (fullScreen_) {
-      cvSetWindowProperty("YOLO V3", CV_WND_PROP_FULLSCREEN, CV_WINDOW_FULLSCREEN);
-    } else {
-      cvMoveWindow("YOLO V3", 0, 0);
-      cvResizeWindow("YOLO V3", 640, 480);
-    }
+    DetectionViewer::Options viewerOptions;
+    viewerOptions.rate = viewRate_;
+    viewerOptions.waitKeyDelay = waitKeyDelay_;
+    viewerOptions.fullScreen = fullScreen_;
+    viewer_ = DetectionViewer::create(viewerOptions, [this](int key) { handleKey(key); });
   }
 
   demoTime_ = what_time_is_it_now();
 
+  bool haveFrame = true;
   while (!demoDone_) {
-    sem_wait(&sem_new_image_);
     buffIndex_ = (buffIndex_ + 1) % 3;
-    fetch_thread = std::thread(&YoloObjectDetector::fetchInThread, this);
-    detect_thread = std::thread(&YoloObjectDetector::detectInThread, this);
+    const bool displayed = buffValid_[(buffIndex_ + 1) % 3];
+    const ScheduledFrame *next = haveFrame ? &frame : nullptr;
+    // Fetch and detect are tasks on the critical lane; this thread helps once it is done
+    // with display and publishing.
+    TaskGroup stages(*taskScheduler_, TaskPriority::Critical);
+    stages.run([this, next] { fetchInThread(next); });
+    stages.run([this] { detectInThread(); });
     if (!demoPrefix_) {
       fps_ = 1./(what_time_is_it_now() - demoTime_);
       demoTime_ = what_time_is_it_now();
-      // if (viewImage_) {
+      if (displayed) {
         displayInThread(0);
-      // }
+      }
       publishInThread();
-    } else {
+    } else if (displayed) {
       char name[256];
       sprintf(name, "%s_%08d", demoPrefix_, count);
       save_image(buff_[(buffIndex_ + 1) % 3], name);
     }
-    fetch_thread.join();
-    detect_thread.join();
+    stages.wait();
     ++count;
+    reportQueueingDelays();
+
+    // The scheduler picks the next frame by class. When none comes, the frames still in
+    // the pipeline are finished, so no result waits for the stream to resume.
+    haveFrame = false;
+    while (isNodeRunning() && !(haveFrame = scheduler_.pop(&frame, pipelineFlushTimeout))) {
+      if (buffValid_[0] || buffValid_[1] || buffValid_[2]) break;
+    }
     if (!isNodeRunning()) {
       demoDone_ = true;
     }
@@ -655,20 +1354,6 @@ void YoloObjectDetector::yolo()
 
 }
 
-IplImageWithHeader_ YoloObjectDetector::getIplImageWithHeader()
-{
-  boost::shared_lock<boost::shared_mutex> lock(mutexImageCallback_);
-  IplImage* ROS_img = new IplImage(camImageCopy_);
-  IplImageWithHeader_ header = {.image = ROS_img, .header = imageHeader_};
-  return header;
-}
-
-bool YoloObjectDetector::getImageStatus(void)
-{
-  boost::shared_lock<boost::shared_mutex> lock(mutexImageStatus_);
-  return imageStatus_;
-}
-
 bool YoloObjectDetector::isNodeRunning(void)
 {
   boost::shared_lock<boost::shared_mutex> lock(mutexNodeStatus_);
@@ -677,69 +1362,67 @@ bool YoloObjectDetector::isNodeRunning(void)
 
 void *YoloObjectDetector::publishInThread()
 {
-  // Publish image.
+  // Nothing was detected in an empty slot or a frame that was dropped as stale.
+  const int slot = (buffIndex_ + 1) % 3;
+  if (!buffValid_[slot]) return 0;
+  buffValid_[slot] = false;
+  const ScheduledFrame& frame = buffFrame_[slot];
+  const bool live = frame.frameClass == FrameClass::Live;
+
+  // Publish image, action goals only get their result.
   cv::Mat cvImage = cv::cvarrToMat(ipl_);
-  if (!publishDetectionImage(cv::Mat(cvImage))) {
+  if (live && !publishDetectionImage(cv::Mat(cvImage))) {
     ROS_DEBUG("Detection image has not been broadcasted.");
   }
 
-  // Publish bounding boxes and detection result.
-  int num = roiBoxes_[0].num;
-  if (num > 0 && num <= 100) {
-    for (int i = 0; i < num; i++) {
-      for (int j = 0; j < numClasses_; j++) {
-        if (roiBoxes_[i].Class == j) {
-          rosBoxes_[j].push_back(roiBoxes_[i]);
-          rosBoxCounter_[j]++;
-        }
+  // Publish bounding boxes and detection result, in one pass over the detected objects. The
+  // topics and the shared ring get the same objects.
+  const RosBox_ *roiBoxes = roiBoxes_[slot];
+  const int num = roiBoxes[0].num;
+  boundingBoxesResults_.clear();
+  for (int i = 0; i < num; i++) {
+    const RosBox_& roi = roiBoxes[i];
+    if (roi.Class >= numClasses_) continue;
+    darknet_ros_msgs::BoundingBox& boundingBox = boundingBoxesResults_.add();
+    boundingBox.Class = classLabels_[roi.Class];
+    boundingBox.probability = roi.prob;
+    boundingBox.xmin = (roi.x - roi.w / 2) * frame.fullWidth;
+    boundingBox.ymin = (roi.y - roi.h / 2) * frame.fullHeight;
+    boundingBox.xmax = (roi.x + roi.w / 2) * frame.fullWidth;
+    boundingBox.ymax = (roi.y + roi.h / 2) * frame.fullHeight;
+    boundingBox.z = roi.z;
+  }
+  boundingBoxesResults_.image_header = frame.header;
+  boundingBoxesResults_.header.stamp = boundingBoxesResults_.image_header.stamp;
+
+  if (live && detectionRing_) {
+    writeDetectionRing(frame, roiBoxes, num);
+  }
+
+  if (live) {
+    // Unchanged detections only renew the heartbeat.
+    if (changeDriven_ && !detectionsChanged()) {
+      heartbeatPublisher_.publish(boundingBoxesResults_.image_header);
+    } else {
+      // Only the count saturates, std_msgs::Int8 holds at most 127.
+      std_msgs::Int8 msg;
+      msg.data = std::min(num, (int) std::numeric_limits<int8_t>::max());
+      objectPublisher_.publish(msg);
+      if (num > 0) {
+        boundingBoxesPublisher_.publish(boundingBoxesResults_);
       }
     }
-
-    std_msgs::Int8 msg;
-    msg.data = num;
-    objectPublisher_.publish(msg);
-
-    for (int i = 0; i < numClasses_; i++) {
-      if (rosBoxCounter_[i] > 0) {
-        darknet_ros_msgs::BoundingBox boundingBox;
-
-        for (int j = 0; j < rosBoxCounter_[i]; j++) {
-          int xmin = (rosBoxes_[i][j].x - rosBoxes_[i][j].w / 2) * frameWidth_;
-          int ymin = (rosBoxes_[i][j].y - rosBoxes_[i][j].h / 2) * frameHeight_;
-          int xmax = (rosBoxes_[i][j].x + rosBoxes_[i][j].w / 2) * frameWidth_;
-          int ymax = (rosBoxes_[i][j].y + rosBoxes_[i][j].h / 2) * frameHeight_;
-
-          boundingBox.Class = classLabels_[i];
-          boundingBox.probability = rosBoxes_[i][j].prob;
-          boundingBox.xmin = xmin;
-          boundingBox.ymin = ymin;
-          boundingBox.xmax = xmax;
-          boundingBox.ymax = ymax;
-          boundingBox.z = rosBoxes_[i][j].z;
-          boundingBoxesResults_.bounding_boxes.push_back(boundingBox);
-        }
+    for (HeadSet& set : headSets_) {
+      if (!set.results[slot].bounding_boxes.empty()) {
+        set.publisher.publish(set.results[slot]);
       }
     }
-    boundingBoxesResults_.image_header = headerBuff_[(buffIndex_ + 1) % 3];
-    boundingBoxesResults_.header.stamp = boundingBoxesResults_.image_header.stamp;
-    boundingBoxesResults_.header.frame_id = "detection";
-    boundingBoxesPublisher_.publish(boundingBoxesResults_);
   } else {
-    std_msgs::Int8 msg;
-    msg.data = 0;
-    objectPublisher_.publish(msg);
-  }
-  if (isCheckingForObjects()) {
     ROS_DEBUG("[YoloObjectDetector] check for objects in image.");
     darknet_ros_msgs::CheckForObjectsResult objectsActionResult;
-    objectsActionResult.id = buffId_[0];
-    objectsActionResult.bounding_boxes = boundingBoxesResults_;
-    checkForObjectsActionServer_->setSucceeded(objectsActionResult, "Send bounding boxes.");
-  }
-  boundingBoxesResults_.bounding_boxes.clear();
-  for (int i = 0; i < numClasses_; i++) {
-    rosBoxes_[i].clear();
-    rosBoxCounter_[i] = 0;
+    objectsActionResult.id = frame.actionId;
+    boundingBoxesResults_.copyTo(&objectsActionResult.bounding_boxes);
+    sendActionResult(frame, objectsActionResult);
   }
 
   return 0;
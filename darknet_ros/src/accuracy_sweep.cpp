@@ -0,0 +1,509 @@
+/*
+ * accuracy_sweep.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+// Runs a labelled image set through every combination of model, input size and threshold
+// with the detection path of the node, and reports mAP, per-class recall, latency and peak
+// memory together with the Pareto frontier of latency, memory and mAP.
+
+#include <darknet_ros/DetectionEvaluation.hpp>
+#include <darknet_ros/OfflineDetector.hpp>
+#include <darknet_ros/TaskScheduler.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+//! Model of the grid, precision is a label of the model file (e.g. an int8 ONNX export).
+struct Model
+{
+  std::string label;
+  std::string config;
+  std::string model;
+  std::string backend = "darknet";
+  std::string precision = "fp32";
+};
+
+//! Input size, 0 keeps the size of the cfg.
+struct Size
+{
+  int width = 0;
+  int height = 0;
+};
+
+struct Arguments
+{
+  std::vector<Model> models;
+  std::vector<Size> sizes = {Size()};
+  std::vector<float> thresholds = {.1f, .2f, .3f, .5f};
+  std::string images;
+  std::string labels;
+  std::string names;
+  float iou = .5f;
+  float nms = .4f;
+  float hier = .5f;
+  int threads = 0;
+  int warmup = 2;
+  std::string csv;
+  std::string json;
+};
+
+//! Result of one configuration of the grid, measured in its own process.
+struct Run
+{
+  const Model *model;
+  int width;
+  int height;
+  int classes;
+  int images;
+  double latencyMean;
+  double latencyP50;
+  double latencyP99;
+  double peakMemory;
+  std::vector<darknet_ros::DetectionEvaluation> evaluations;
+};
+
+//! Point of the report: a run at one threshold.
+struct Point
+{
+  const Run *run;
+  float threshold;
+  const darknet_ros::DetectionEvaluation *evaluation;
+  bool pareto;
+};
+
+void usage()
+{
+  fprintf(stderr,
+          "Usage: accuracy_sweep --model LABEL,CFG,MODEL[,BACKEND[,PRECISION]] [--model ...] --images DIR [options]\n"
+          "  --sizes LIST         network input sizes, e.g. 320,416,608x352, 0 for the cfg's (default 0)\n"
+          "  --thresholds LIST    detection thresholds, default .1,.2,.3,.5\n"
+          "  --labels DIR         darknet label files, default next to the images\n"
+          "  --names FILE         class names, one per line\n"
+          "  --iou X              overlap a detection needs to match a label, default .5\n"
+          "  --nms X              overlap of non-maximum suppression, default .4\n"
+          "  --threads N          task scheduler threads, default all cores\n"
+          "  --warmup N           runs on the first image before measuring, default 2\n"
+          "  --csv FILE           write the report as CSV\n"
+          "  --json FILE          write the report as JSON, with per-class recall and AP\n");
+}
+
+std::vector<std::string> split(const std::string& text, char separator)
+{
+  std::vector<std::string> items;
+  std::stringstream stream(text);
+  std::string item;
+  while (std::getline(stream, item, separator)) {
+    items.push_back(item);
+  }
+  return items;
+}
+
+bool parseModel(const std::string& text, std::vector<Model> *models)
+{
+  const std::vector<std::string> fields = split(text, ',');
+  if (fields.size() < 3 || fields.size() > 5) return false;
+  Model model;
+  model.label = fields[0];
+  model.config = fields[1];
+  model.model = fields[2];
+  if (fields.size() > 3) model.backend = fields[3];
+  if (fields.size() > 4) model.precision = fields[4];
+  models->push_back(model);
+  return true;
+}
+
+bool parseSizes(const std::string& text, std::vector<Size> *sizes)
+{
+  sizes->clear();
+  for (const std::string& item : split(text, ',')) {
+    Size size;
+    const size_t x = item.find('x');
+    size.width = atoi(item.substr(0, x).c_str());
+    size.height = x == std::string::npos ? size.width : atoi(item.substr(x + 1).c_str());
+    if (size.width < 0 || size.height < 0 || (size.width == 0) != (size.height == 0)) return false;
+    sizes->push_back(size);
+  }
+  return !sizes->empty();
+}
+
+bool parseThresholds(const std::string& text, std::vector<float> *thresholds)
+{
+  thresholds->clear();
+  for (const std::string& item : split(text, ',')) {
+    const float value = atof(item.c_str());
+    if (value <= 0 || value >= 1) return false;
+    thresholds->push_back(value);
+  }
+  std::sort(thresholds->begin(), thresholds->end());
+  return !thresholds->empty();
+}
+
+bool parseArguments(int argc, char **argv, Arguments *arguments)
+{
+  for (int i = 1; i < argc; ++i) {
+    const std::string flag = argv[i];
+    if (i + 1 == argc) return false;
+    const std::string value = argv[++i];
+    bool valid = true;
+    if (flag == "--model") {
+      valid = parseModel(value, &arguments->models);
+    } else if (flag == "--sizes") {
+      valid = parseSizes(value, &arguments->sizes);
+    } else if (flag == "--thresholds") {
+      valid = parseThresholds(value, &arguments->thresholds);
+    } else if (flag == "--images") {
+      arguments->images = value;
+    } else if (flag == "--labels") {
+      arguments->labels = value;
+    } else if (flag == "--names") {
+      arguments->names = value;
+    } else if (flag == "--iou") {
+      arguments->iou = atof(value.c_str());
+      valid = arguments->iou > 0 && arguments->iou <= 1;
+    } else if (flag == "--nms") {
+      arguments->nms = atof(value.c_str());
+      valid = arguments->nms >= 0 && arguments->nms <= 1;
+    } else if (flag == "--threads") {
+      arguments->threads = atoi(value.c_str());
+      valid = arguments->threads >= 0;
+    } else if (flag == "--warmup") {
+      arguments->warmup = atoi(value.c_str());
+      valid = arguments->warmup >= 0;
+    } else if (flag == "--csv") {
+      arguments->csv = value;
+    } else if (flag == "--json") {
+      arguments->json = value;
+    } else {
+      valid = false;
+    }
+    if (!valid) return false;
+  }
+  return !arguments->models.empty() && !arguments->images.empty();
+}
+
+double percentile(std::vector<double> values, double fraction)
+{
+  if (values.empty()) return 0;
+  std::sort(values.begin(), values.end());
+  return values[(size_t) (fraction * (values.size() - 1) + .5)];
+}
+
+/*!
+ * Child process of a configuration: loads the model, detects on every image and writes
+ * classes, input size, image count, latencies and one evaluation per threshold to fd.
+ */
+int measure(const Arguments& arguments, const Model& model, const Size& size, const std::vector<std::string>& files,
+            const std::vector<darknet_ros::EvaluatedBox>& labels, int fd)
+{
+  darknet_ros::TaskScheduler scheduler(arguments.threads > 0 ? arguments.threads
+                                                             : darknet_ros::TaskScheduler::allottedCores());
+  darknet_ros::TaskScheduler::setDefault(&scheduler);
+
+  darknet_ros::OfflineDetector::Options options;
+  options.backend = model.backend;
+  options.darknet.inputWidth = size.width;
+  options.darknet.inputHeight = size.height;
+  options.onnxThreads = scheduler.concurrency();
+  options.threshold = arguments.thresholds.front();
+  options.hier = arguments.hier;
+  options.nms = arguments.nms;
+  darknet_ros::OfflineDetector detector(options);
+  if (!detector.load(model.config, model.model)) return EXIT_FAILURE;
+  const int classes = detector.classes();
+  image input = detector.makeInput();
+
+  std::vector<darknet_ros::EvaluatedBox> detections;
+  std::vector<darknet_ros::OfflineDetection> found;
+  std::vector<double> latencies;
+  for (int i = 0; i < (int) files.size(); ++i) {
+    darknet_ros::CameraFrame frame;
+    if (!darknet_ros::loadImageFrame(files[i], &frame)) {
+      fprintf(stderr, "Could not read %s.\n", files[i].c_str());
+      continue;
+    }
+    for (int w = i == 0 ? arguments.warmup : 0; w > 0; --w) {
+      darknet_ros::OfflineDetector::fetch(frame, input);
+      detector.detect(input, frame.width, frame.height, &found);
+    }
+    const Clock::time_point start = Clock::now();
+    darknet_ros::OfflineDetector::fetch(frame, input);
+    detector.detect(input, frame.width, frame.height, &found);
+    latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    for (const darknet_ros::OfflineDetection& d : found) {
+      detections.push_back({i, d.classId, d.probability, d.xmin / frame.width, d.ymin / frame.height,
+                            d.xmax / frame.width, d.ymax / frame.height});
+    }
+  }
+  free_image(input);
+
+  double mean = 0;
+  for (double latency : latencies) {
+    mean += latency;
+  }
+  std::vector<double> values = {double(classes),
+                                double(detector.backend().inputWidth()),
+                                double(detector.backend().inputHeight()),
+                                double(latencies.size()),
+                                latencies.empty() ? 0 : mean / latencies.size(),
+                                percentile(latencies, .5),
+                                percentile(latencies, .99)};
+  for (float threshold : arguments.thresholds) {
+    const darknet_ros::DetectionEvaluation e =
+        darknet_ros::evaluateDetections(labels, detections, files.size(), classes, threshold, arguments.iou);
+    values.push_back(e.map);
+    values.push_back(e.precision);
+    values.push_back(e.recall);
+    values.insert(values.end(), e.classAp.begin(), e.classAp.end());
+    values.insert(values.end(), e.classRecall.begin(), e.classRecall.end());
+  }
+  const char *data = reinterpret_cast<const char *>(values.data());
+  size_t left = values.size() * sizeof(double);
+  while (left > 0) {
+    const ssize_t written = write(fd, data, left);
+    if (written <= 0) return EXIT_FAILURE;
+    data += written;
+    left -= written;
+  }
+  return EXIT_SUCCESS;
+}
+
+/*!
+ * Measures a configuration in a child process, so that its peak memory is its own and every
+ * network is released with it.
+ * @return false if the configuration failed.
+ */
+bool runConfiguration(const Arguments& arguments, const Model& model, const Size& size,
+                      const std::vector<std::string>& files, const std::vector<darknet_ros::EvaluatedBox>& labels,
+                      Run *run)
+{
+  int pipes[2];
+  if (pipe(pipes) != 0) return false;
+  fflush(stdout);
+  fflush(stderr);
+  const pid_t child = fork();
+  if (child < 0) {
+    close(pipes[0]);
+    close(pipes[1]);
+    return false;
+  }
+  if (child == 0) {
+    close(pipes[0]);
+    const int status = measure(arguments, model, size, files, labels, pipes[1]);
+    close(pipes[1]);
+    _exit(status);
+  }
+
+  close(pipes[1]);
+  std::vector<double> values;
+  double buffer[256];
+  size_t pending = 0;
+  ssize_t received;
+  while ((received = read(pipes[0], reinterpret_cast<char *>(buffer) + pending, sizeof(buffer) - pending)) > 0) {
+    pending += received;
+    const size_t complete = pending / sizeof(double);
+    values.insert(values.end(), buffer, buffer + complete);
+    pending -= complete * sizeof(double);
+    memmove(buffer, buffer + complete, pending);
+  }
+  close(pipes[0]);
+
+  int status;
+  rusage usage;
+  if (wait4(child, &status, 0, &usage) != child || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+    return false;
+  }
+  if (values.size() < 7) return false;
+  const int classes = values[0];
+  if (values.size() != 7 + arguments.thresholds.size() * (3 + 2 * classes)) return false;
+
+  run->model = &model;
+  run->classes = classes;
+  run->width = values[1];
+  run->height = values[2];
+  run->images = values[3];
+  run->latencyMean = values[4];
+  run->latencyP50 = values[5];
+  run->latencyP99 = values[6];
+  run->peakMemory = usage.ru_maxrss / 1024.;
+  std::vector<double>::const_iterator value = values.begin() + 7;
+  for (size_t t = 0; t < arguments.thresholds.size(); ++t) {
+    darknet_ros::DetectionEvaluation e;
+    e.map = *value++;
+    e.precision = *value++;
+    e.recall = *value++;
+    e.classAp.assign(value, value + classes);
+    value += classes;
+    e.classRecall.assign(value, value + classes);
+    value += classes;
+    run->evaluations.push_back(e);
+  }
+  return true;
+}
+
+std::string className(const std::vector<std::string>& names, int c)
+{
+  return c < (int) names.size() ? names[c] : "class " + std::to_string(c);
+}
+
+std::string quoted(const std::string& text)
+{
+  std::string result = "\"";
+  for (char c : text) {
+    if (c == '"' || c == '\\') result += '\\';
+    result += c;
+  }
+  return result + "\"";
+}
+
+bool writeCsv(const std::string& file, const std::vector<Point>& points)
+{
+  FILE *out = fopen(file.c_str(), "w");
+  if (!out) return false;
+  fprintf(out,
+          "model,backend,precision,width,height,threshold,map,precision_score,recall,latency_mean_ms,latency_p50_ms,"
+          "latency_p99_ms,peak_memory_mb,pareto\n");
+  for (const Point& p : points) {
+    const Run& r = *p.run;
+    fprintf(out, "%s,%s,%s,%d,%d,%.3f,%.4f,%.4f,%.4f,%.3f,%.3f,%.3f,%.1f,%d\n", r.model->label.c_str(),
+            r.model->backend.c_str(), r.model->precision.c_str(), r.width, r.height, p.threshold, p.evaluation->map,
+            p.evaluation->precision, p.evaluation->recall, r.latencyMean, r.latencyP50, r.latencyP99, r.peakMemory,
+            p.pareto ? 1 : 0);
+  }
+  fclose(out);
+  return true;
+}
+
+bool writeJson(const std::string& file, const Arguments& arguments, const std::vector<std::string>& names,
+               const std::vector<Point>& points)
+{
+  FILE *out = fopen(file.c_str(), "w");
+  if (!out) return false;
+  fprintf(out, "{\n  \"images\": %s,\n  \"iou\": %.2f,\n  \"points\": [\n", quoted(arguments.images).c_str(),
+          arguments.iou);
+  for (size_t i = 0; i < points.size(); ++i) {
+    const Point& p = points[i];
+    const Run& r = *p.run;
+    fprintf(out,
+            "    {\"model\": %s, \"backend\": %s, \"precision\": %s, \"width\": %d, \"height\": %d, "
+            "\"threshold\": %.3f, \"map\": %.4f, \"precision_score\": %.4f, \"recall\": %.4f, "
+            "\"latency_mean_ms\": %.3f, \"latency_p50_ms\": %.3f, \"latency_p99_ms\": %.3f, "
+            "\"peak_memory_mb\": %.1f, \"pareto\": %s,\n     \"classes\": {",
+            quoted(r.model->label).c_str(), quoted(r.model->backend).c_str(), quoted(r.model->precision).c_str(),
+            r.width, r.height, p.threshold, p.evaluation->map, p.evaluation->precision, p.evaluation->recall,
+            r.latencyMean, r.latencyP50, r.latencyP99, r.peakMemory, p.pareto ? "true" : "false");
+    for (int c = 0; c < r.classes; ++c) {
+      fprintf(out, "%s%s: {\"ap\": %.4f, \"recall\": %.4f}", c ? ", " : "", quoted(className(names, c)).c_str(),
+              p.evaluation->classAp[c], p.evaluation->classRecall[c]);
+    }
+    fprintf(out, "}}%s\n", i + 1 < points.size() ? "," : "");
+  }
+  fprintf(out, "  ]\n}\n");
+  fclose(out);
+  return true;
+}
+
+} /* namespace */
+
+int main(int argc, char **argv)
+{
+  Arguments arguments;
+  if (!parseArguments(argc, argv, &arguments)) {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  const std::vector<std::string> files = darknet_ros::listImages(arguments.images);
+  if (files.empty()) {
+    fprintf(stderr, "No images found in %s.\n", arguments.images.c_str());
+    return EXIT_FAILURE;
+  }
+  std::vector<darknet_ros::EvaluatedBox> labels;
+  for (int i = 0; i < (int) files.size(); ++i) {
+    darknet_ros::readDarknetLabels(files[i], arguments.labels, i, &labels);
+  }
+  if (labels.empty()) {
+    fprintf(stderr, "No labels found for the images in %s.\n", arguments.images.c_str());
+    return EXIT_FAILURE;
+  }
+  std::vector<std::string> names;
+  if (!arguments.names.empty()) {
+    std::ifstream stream(arguments.names.c_str());
+    std::string name;
+    while (std::getline(stream, name)) {
+      names.push_back(name);
+    }
+  }
+  printf("%d images, %d labelled objects.\n", (int) files.size(), (int) labels.size());
+
+  // ONNX exports run at the size they were exported with, only darknet models are resized.
+  std::vector<Run> runs;
+  runs.reserve(arguments.models.size() * arguments.sizes.size());
+  for (const Model& model : arguments.models) {
+    const std::vector<Size> sizes = model.backend == "darknet" ? arguments.sizes : std::vector<Size>(1);
+    for (const Size& size : sizes) {
+      Run run;
+      if (!runConfiguration(arguments, model, size, files, labels, &run)) {
+        fprintf(stderr, "%s at %dx%d failed.\n", model.label.c_str(), size.width, size.height);
+        continue;
+      }
+      runs.push_back(run);
+      printf("%s (%s, %s) at %dx%d: %.2f ms per image, %.1f MB.\n", model.label.c_str(), model.backend.c_str(),
+             model.precision.c_str(), run.width, run.height, run.latencyMean, run.peakMemory);
+    }
+  }
+  if (runs.empty()) return EXIT_FAILURE;
+
+  std::vector<Point> points;
+  for (const Run& run : runs) {
+    for (size_t t = 0; t < arguments.thresholds.size(); ++t) {
+      points.push_back({&run, arguments.thresholds[t], &run.evaluations[t], false});
+    }
+  }
+  std::vector<darknet_ros::OperatingPoint> tradeoffs;
+  for (const Point& p : points) {
+    tradeoffs.push_back({p.run->latencyMean, p.run->peakMemory, p.evaluation->map, false});
+  }
+  darknet_ros::markPareto(&tradeoffs);
+  for (size_t i = 0; i < points.size(); ++i) {
+    points[i].pareto = tradeoffs[i].pareto;
+  }
+  std::sort(points.begin(), points.end(),
+            [](const Point& a, const Point& b) { return a.run->latencyMean < b.run->latencyMean; });
+
+  printf("\n%-20s %-9s %9s %6s %7s %7s %7s %9s %9s %8s\n", "model", "precision", "input", "thresh", "mAP", "prec",
+         "recall", "mean [ms]", "p99 [ms]", "mem [MB]");
+  for (const Point& p : points) {
+    const std::string input = std::to_string(p.run->width) + "x" + std::to_string(p.run->height);
+    printf("%-20s %-9s %9s %6.2f %7.4f %7.4f %7.4f %9.2f %9.2f %8.1f%s\n", p.run->model->label.c_str(),
+           p.run->model->precision.c_str(), input.c_str(), p.threshold, p.evaluation->map, p.evaluation->precision,
+           p.evaluation->recall, p.run->latencyMean, p.run->latencyP99, p.run->peakMemory, p.pareto ? " *" : "");
+  }
+  printf("* Pareto frontier of latency, memory and mAP.\n");
+
+  if (!arguments.csv.empty() && !writeCsv(arguments.csv, points)) {
+    fprintf(stderr, "Could not write %s.\n", arguments.csv.c_str());
+    return EXIT_FAILURE;
+  }
+  if (!arguments.json.empty() && !writeJson(arguments.json, arguments, names, points)) {
+    fprintf(stderr, "Could not write %s.\n", arguments.json.c_str());
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,394 @@
+/*
+ * scaling_benchmark.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+// Runs the detection path of the node over recorded images for every combination of scheduler
+// threads, pipeline depth, replicas and batch size, and reports throughput, latency and CPU
+// time per frame as CSV and JSON.
+
+#include <darknet_ros/OfflineDetector.hpp>
+#include <darknet_ros/TaskScheduler.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Arguments
+{
+  std::string config;
+  std::string model;
+  std::string images;
+  std::string backend = "darknet";
+  std::vector<int> threads;
+  std::vector<int> depths = {1, 2, 3};
+  std::vector<int> replicas = {1, 2};
+  std::vector<int> batches = {1};
+  int frames = 100;
+  int warmup = 10;
+  std::string csv;
+  std::string json;
+};
+
+struct Point
+{
+  int threads;
+  int depth;
+  int replicas;
+  int batch;
+  int frames;
+  double fps;
+  double latencyP50;
+  double latencyP99;
+  double cpuPerFrame;
+};
+
+void usage()
+{
+  fprintf(stderr,
+          "Usage: scaling_benchmark --config CFG --model WEIGHTS --images DIR [options]\n"
+          "  --backend NAME       darknet (default) or onnxruntime\n"
+          "  --threads LIST       scheduler threads, e.g. 1,2,4 (default: powers of two up to all cores)\n"
+          "  --depths LIST        pipeline depth 1 (sequential) to 3 (fetch, detect and publish overlap),\n"
+          "                       default 1,2,3\n"
+          "  --replicas LIST      networks detecting concurrently, default 1,2\n"
+          "  --batches LIST       frames arriving together, default 1\n"
+          "  --frames N           measured frames per point, default 100\n"
+          "  --warmup N           frames before measuring, default 10\n"
+          "  --csv FILE           write the report as CSV\n"
+          "  --json FILE          write the report as JSON\n");
+}
+
+bool parseList(const std::string& text, std::vector<int> *values)
+{
+  values->clear();
+  std::stringstream stream(text);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    const int value = atoi(item.c_str());
+    if (value <= 0) return false;
+    values->push_back(value);
+  }
+  return !values->empty();
+}
+
+bool parseArguments(int argc, char **argv, Arguments *arguments)
+{
+  for (int i = 1; i < argc; ++i) {
+    const std::string flag = argv[i];
+    if (i + 1 == argc) return false;
+    const std::string value = argv[++i];
+    bool valid = true;
+    if (flag == "--config") {
+      arguments->config = value;
+    } else if (flag == "--model") {
+      arguments->model = value;
+    } else if (flag == "--images") {
+      arguments->images = value;
+    } else if (flag == "--backend") {
+      arguments->backend = value;
+    } else if (flag == "--threads") {
+      valid = parseList(value, &arguments->threads);
+    } else if (flag == "--depths") {
+      valid = parseList(value, &arguments->depths);
+    } else if (flag == "--replicas") {
+      valid = parseList(value, &arguments->replicas);
+    } else if (flag == "--batches") {
+      valid = parseList(value, &arguments->batches);
+    } else if (flag == "--frames") {
+      arguments->frames = atoi(value.c_str());
+      valid = arguments->frames > 0;
+    } else if (flag == "--warmup") {
+      arguments->warmup = atoi(value.c_str());
+      valid = arguments->warmup >= 0;
+    } else if (flag == "--csv") {
+      arguments->csv = value;
+    } else if (flag == "--json") {
+      arguments->json = value;
+    } else {
+      valid = false;
+    }
+    if (!valid) return false;
+  }
+  if (arguments->threads.empty()) {
+    const int cores = darknet_ros::TaskScheduler::allottedCores();
+    for (int threads = 1; threads < cores; threads *= 2) {
+      arguments->threads.push_back(threads);
+    }
+    arguments->threads.push_back(cores);
+  }
+  return !arguments->config.empty() && !arguments->model.empty() && !arguments->images.empty();
+}
+
+double processCpuSeconds()
+{
+  timespec time;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+  return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+/*!
+ * Hands out frames in bursts of batch frames that arrive together; the next burst arrives as
+ * soon as the last frame of the previous one is taken.
+ */
+class FrameSource
+{
+ public:
+  FrameSource(int frames, int batch)
+      : frames_(frames),
+        batch_(batch)
+  {
+  }
+
+  bool take(int *index, Clock::time_point *arrival)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (next_ == frames_) return false;
+    if (next_ == arrived_) {
+      arrived_ = std::min(frames_, next_ + batch_);
+      arrival_ = Clock::now();
+    }
+    *index = next_++;
+    *arrival = arrival_;
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  int frames_;
+  int batch_;
+  int next_ = 0;
+  int arrived_ = 0;
+  Clock::time_point arrival_;
+};
+
+//! Pipeline slot of a replica.
+struct Slot
+{
+  bool valid = false;
+  int frame = 0;
+  Clock::time_point arrival;
+  image input;
+  std::vector<darknet_ros::OfflineDetection> detections;
+};
+
+/*!
+ * One replica: its own network running the fetch, detect and publish stages of the node on
+ * three slots. Depth 1 runs them one after the other, depth 2 fetches the next frame while
+ * the current one is detected and published, depth 3 overlaps all three like the node.
+ */
+void runReplica(darknet_ros::OfflineDetector *detector, const std::vector<darknet_ros::CameraFrame>& frames,
+                FrameSource *source, darknet_ros::TaskScheduler *scheduler, int depth, std::vector<double> *latencies)
+{
+  Slot slots[3];
+  for (Slot& slot : slots) {
+    slot.input = detector->makeInput();
+  }
+  auto fetch = [&](Slot& slot) {
+    int index;
+    slot.valid = source->take(&index, &slot.arrival);
+    if (!slot.valid) return;
+    slot.frame = index % frames.size();
+    darknet_ros::OfflineDetector::fetch(frames[slot.frame], slot.input);
+  };
+  auto detect = [&](Slot& slot) {
+    if (!slot.valid) return;
+    const darknet_ros::CameraFrame& frame = frames[slot.frame];
+    detector->detect(slot.input, frame.width, frame.height, &slot.detections);
+  };
+  auto publish = [&](Slot& slot) {
+    if (!slot.valid) return;
+    latencies->push_back(std::chrono::duration<double, std::milli>(Clock::now() - slot.arrival).count());
+    slot.valid = false;
+  };
+
+  for (int step = 0;; ++step) {
+    Slot& fetched = slots[step % 3];
+    Slot& detected = slots[(step + 2) % 3];
+    Slot& published = slots[(step + 1) % 3];
+    if (depth <= 1) {
+      fetch(fetched);
+      if (!fetched.valid) break;
+      detect(fetched);
+      publish(fetched);
+    } else if (depth == 2) {
+      darknet_ros::TaskGroup stages(*scheduler, darknet_ros::TaskPriority::Critical);
+      stages.run([&] { fetch(fetched); });
+      detect(detected);
+      publish(detected);
+      stages.wait();
+      if (!fetched.valid) break;
+    } else {
+      darknet_ros::TaskGroup stages(*scheduler, darknet_ros::TaskPriority::Critical);
+      stages.run([&] { fetch(fetched); });
+      stages.run([&] { detect(detected); });
+      publish(published);
+      stages.wait();
+      if (!fetched.valid && !detected.valid) break;
+    }
+  }
+
+  for (Slot& slot : slots) {
+    free_image(slot.input);
+  }
+}
+
+/*!
+ * Runs frames through the replicas.
+ * @return latency of every frame in ms.
+ */
+std::vector<double> runFrames(const std::vector<std::unique_ptr<darknet_ros::OfflineDetector> >& detectors,
+                              const std::vector<darknet_ros::CameraFrame>& frames,
+                              darknet_ros::TaskScheduler *scheduler, int count, int depth, int replicas, int batch)
+{
+  FrameSource source(count, batch);
+  std::vector<std::vector<double> > latencies(replicas);
+  std::vector<std::thread> threads;
+  for (int r = 0; r < replicas; ++r) {
+    threads.emplace_back(runReplica, detectors[r].get(), std::cref(frames), &source, scheduler, depth,
+                         &latencies[r]);
+  }
+  std::vector<double> all;
+  for (int r = 0; r < replicas; ++r) {
+    threads[r].join();
+    all.insert(all.end(), latencies[r].begin(), latencies[r].end());
+  }
+  return all;
+}
+
+double percentile(std::vector<double> values, double fraction)
+{
+  if (values.empty()) return 0;
+  std::sort(values.begin(), values.end());
+  return values[(size_t) (fraction * (values.size() - 1) + .5)];
+}
+
+bool writeCsv(const std::string& file, const std::vector<Point>& points)
+{
+  FILE *out = fopen(file.c_str(), "w");
+  if (!out) return false;
+  fprintf(out, "threads,depth,replicas,batch,frames,fps,latency_p50_ms,latency_p99_ms,cpu_ms_per_frame\n");
+  for (const Point& p : points) {
+    fprintf(out, "%d,%d,%d,%d,%d,%.3f,%.3f,%.3f,%.3f\n", p.threads, p.depth, p.replicas, p.batch, p.frames, p.fps,
+            p.latencyP50, p.latencyP99, p.cpuPerFrame);
+  }
+  fclose(out);
+  return true;
+}
+
+bool writeJson(const std::string& file, const Arguments& arguments, const std::vector<Point>& points)
+{
+  FILE *out = fopen(file.c_str(), "w");
+  if (!out) return false;
+  fprintf(out, "{\n  \"config\": \"%s\",\n  \"model\": \"%s\",\n  \"backend\": \"%s\",\n  \"cores\": %d,\n",
+          arguments.config.c_str(), arguments.model.c_str(), arguments.backend.c_str(),
+          darknet_ros::TaskScheduler::allottedCores());
+  fprintf(out, "  \"points\": [\n");
+  for (size_t i = 0; i < points.size(); ++i) {
+    const Point& p = points[i];
+    fprintf(out,
+            "    {\"threads\": %d, \"depth\": %d, \"replicas\": %d, \"batch\": %d, \"frames\": %d, "
+            "\"fps\": %.3f, \"latency_p50_ms\": %.3f, \"latency_p99_ms\": %.3f, \"cpu_ms_per_frame\": %.3f}%s\n",
+            p.threads, p.depth, p.replicas, p.batch, p.frames, p.fps, p.latencyP50, p.latencyP99, p.cpuPerFrame,
+            i + 1 < points.size() ? "," : "");
+  }
+  fprintf(out, "  ]\n}\n");
+  fclose(out);
+  return true;
+}
+
+} /* namespace */
+
+int main(int argc, char **argv)
+{
+  Arguments arguments;
+  if (!parseArguments(argc, argv, &arguments)) {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  // Frames are decoded once, the benchmark starts at the node's fetch stage.
+  std::vector<darknet_ros::CameraFrame> frames;
+  for (const std::string& file : darknet_ros::listImages(arguments.images)) {
+    darknet_ros::CameraFrame frame;
+    if (darknet_ros::loadImageFrame(file, &frame)) frames.push_back(frame);
+  }
+  if (frames.empty()) {
+    fprintf(stderr, "No images found in %s.\n", arguments.images.c_str());
+    return EXIT_FAILURE;
+  }
+
+  // One network per replica, loaded once for all points.
+  darknet_ros::OfflineDetector::Options options;
+  options.backend = arguments.backend;
+  const int maxReplicas = *std::max_element(arguments.replicas.begin(), arguments.replicas.end());
+  std::vector<std::unique_ptr<darknet_ros::OfflineDetector> > detectors;
+  for (int r = 0; r < maxReplicas; ++r) {
+    detectors.emplace_back(new darknet_ros::OfflineDetector(options));
+    if (!detectors.back()->load(arguments.config, arguments.model)) {
+      fprintf(stderr, "The %s backend could not load %s.\n", arguments.backend.c_str(), arguments.model.c_str());
+      return EXIT_FAILURE;
+    }
+  }
+  printf("%d images, %d cores.\n", (int) frames.size(), darknet_ros::TaskScheduler::allottedCores());
+  printf("threads depth replicas batch      fps  p50 [ms]  p99 [ms]  cpu [ms/frame]\n");
+
+  std::vector<Point> points;
+  for (int threads : arguments.threads) {
+    darknet_ros::TaskScheduler scheduler(threads);
+    darknet_ros::TaskScheduler::setDefault(&scheduler);
+    for (int depth : arguments.depths) {
+      for (int replicas : arguments.replicas) {
+        for (int batch : arguments.batches) {
+          runFrames(detectors, frames, &scheduler, arguments.warmup, depth, replicas, batch);
+
+          const double cpuStart = processCpuSeconds();
+          const Clock::time_point start = Clock::now();
+          const std::vector<double> latencies =
+              runFrames(detectors, frames, &scheduler, arguments.frames, depth, replicas, batch);
+          const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+          const double cpu = processCpuSeconds() - cpuStart;
+
+          Point point;
+          point.threads = threads;
+          point.depth = depth;
+          point.replicas = replicas;
+          point.batch = batch;
+          point.frames = arguments.frames;
+          point.fps = arguments.frames / seconds;
+          point.latencyP50 = percentile(latencies, .5);
+          point.latencyP99 = percentile(latencies, .99);
+          point.cpuPerFrame = 1e3 * cpu / arguments.frames;
+          points.push_back(point);
+          printf("%7d %5d %8d %5d %8.2f %9.2f %9.2f %15.2f\n", threads, depth, replicas, batch, point.fps,
+                 point.latencyP50, point.latencyP99, point.cpuPerFrame);
+          fflush(stdout);
+        }
+      }
+    }
+    darknet_ros::TaskScheduler::setDefault(nullptr);
+  }
+
+  if (!arguments.csv.empty() && !writeCsv(arguments.csv, points)) {
+    fprintf(stderr, "Could not write %s.\n", arguments.csv.c_str());
+    return EXIT_FAILURE;
+  }
+  if (!arguments.json.empty() && !writeJson(arguments.json, arguments, points)) {
+    fprintf(stderr, "Could not write %s.\n", arguments.json.c_str());
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
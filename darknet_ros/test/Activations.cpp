@@ -0,0 +1,74 @@
+/*
+ * Activations.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// darknet_ros
+#include "darknet_ros/Activations.hpp"
+
+extern "C" {
+#include "activations.h"
+}
+
+using namespace darknet_ros;
+
+namespace {
+
+const ACTIVATION AllActivations[] = {LOGISTIC, RELU, RELIE, LINEAR, RAMP, TANH, PLSE,
+                                     LEAKY, ELU, LOGGY, STAIR, HARDTAN, LHTAN, SELU};
+
+//! Values over [-20, 20), not a multiple of any vector width long.
+std::vector<float> testValues()
+{
+  std::vector<float> values(1003);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = -20 + 40.f * i / values.size();
+  }
+  return values;
+}
+
+float relativeError(float actual, float expected)
+{
+  return std::fabs(actual - expected) / std::max(1.f, std::fabs(expected));
+}
+
+} /* namespace */
+
+TEST(Activations, MatchDarknet)
+{
+  const std::vector<float> values = testValues();
+  for (ACTIVATION a : AllActivations) {
+    std::vector<float> x = values;
+    activationKernel(a)(x.data(), x.size());
+    float error = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+      error = std::max(error, relativeError(x[i], activate(values[i], a)));
+    }
+    EXPECT_LT(error, 1e-5f) << "activation " << a;
+  }
+}
+
+TEST(Activations, AffineMatchesDarknet)
+{
+  const std::vector<float> values = testValues();
+  const float scale = .5f;
+  const float shift = .25f;
+  for (ACTIVATION a : AllActivations) {
+    std::vector<float> x = values;
+    affineActivationKernel(a)(x.data(), x.size(), scale, shift);
+    float error = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+      error = std::max(error, relativeError(x[i], activate(values[i] * scale + shift, a)));
+    }
+    EXPECT_LT(error, 1e-5f) << "activation " << a;
+  }
+}
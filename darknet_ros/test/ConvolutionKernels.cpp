@@ -0,0 +1,168 @@
+/*
+ * ConvolutionKernels.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+// darknet_ros
+#include "darknet_ros/Activations.hpp"
+#include "darknet_ros/ConvolutionAutotuner.hpp"
+#include "darknet_ros/ConvolutionKernels.hpp"
+#include "RandomNetwork.hpp"
+
+using namespace darknet_ros;
+
+namespace {
+
+//! Bound of maxError() for kernels that sum in another order than darknet.
+const float Tolerance = 1e-4f;
+
+/*
+ * Random network together with darknet's output of every layer, computed before any kernel
+ * is installed.
+ */
+class ConvolutionKernelsTest : public ::testing::Test
+{
+ protected:
+  virtual const char *cfg() const { return "random_network.cfg"; }
+
+  void SetUp() override
+  {
+    net_ = loadRandomNetwork(cfg());
+    input_ = randomInput(net_);
+    reference_ = layerOutputs(net_, input_);
+  }
+
+  void TearDown() override
+  {
+    clearConvolutionKernels(net_);
+    free_network(net_);
+  }
+
+  //! Network state darknet passes to the forward function of layer i.
+  network layerState(int i)
+  {
+    network state = *net_;
+    state.index = i;
+    state.input = i == 0 ? input_.data() : reference_[i - 1].data();
+    state.train = 0;
+    return state;
+  }
+
+  //! Error of one kernel on layer i against darknet, for darknet's input of the layer.
+  float planError(int i, const ConvolutionPlan& plan)
+  {
+    layer& l = net_->layers[i];
+    ConvolutionKernel kernel(l, plan);
+    std::fill(l.output, l.output + l.outputs * l.batch, 0.f);
+    kernel.forward(l, layerState(i));
+    return maxError(l.output, reference_[i]);
+  }
+
+  void expectNetworkMatches()
+  {
+    const std::vector<std::vector<float> > outputs = layerOutputs(net_, input_);
+    for (int i = 0; i < net_->n; ++i) {
+      EXPECT_LT(maxError(outputs[i], reference_[i]), Tolerance) << "layer " << i;
+    }
+  }
+
+  network *net_;
+  std::vector<float> input_;
+  std::vector<std::vector<float> > reference_;
+};
+
+//! Network of test/xnor_network.cfg, a float first layer and three xnor layers.
+class XnorKernelsTest : public ConvolutionKernelsTest
+{
+ protected:
+  const char *cfg() const override { return "xnor_network.cfg"; }
+};
+
+} /* namespace */
+
+TEST_F(ConvolutionKernelsTest, EveryPlanMatchesDarknet)
+{
+  std::set<ConvolutionAlgorithm> tested;
+  for (int i = 0; i < net_->n; ++i) {
+    layer& l = net_->layers[i];
+    if (l.type != CONVOLUTIONAL) continue;
+
+    // Beside the candidates, im2col+GEMM over tiles of a few output rows.
+    std::vector<ConvolutionPlan> plans = candidatePlans(l);
+    for (int rows = 1; rows <= 3; ++rows) {
+      ConvolutionPlan plan;
+      plan.tile = rows;
+      plans.push_back(plan);
+    }
+
+    for (const ConvolutionPlan& plan : plans) {
+      EXPECT_LT(planError(i, plan), Tolerance)
+          << "layer " << i << ", " << algorithmName(plan.algorithm) << ", tile " << plan.tile;
+      tested.insert(plan.algorithm);
+    }
+  }
+  EXPECT_EQ(4u, tested.size()) << "the network should exercise every float algorithm";
+}
+
+TEST_F(ConvolutionKernelsTest, DefaultKernelsMatchDarknet)
+{
+  EXPECT_GT(installDefaultConvolutionKernels(net_), 0);
+  EXPECT_GT(installVectorizedActivations(net_), 0);
+  shrinkWorkspace(net_);
+  expectNetworkMatches();
+}
+
+TEST_F(ConvolutionKernelsTest, TunedKernelsMatchDarknet)
+{
+  char cache[] = "/tmp/darknet_ros_tuning_XXXXXX";
+  const int file = mkstemp(cache);
+  ASSERT_GE(file, 0);
+  close(file);
+
+  EXPECT_GT(ConvolutionAutotuner(cache, 1).tune(net_), 0);
+  expectNetworkMatches();
+
+  // A second run takes every plan from the cache.
+  clearConvolutionKernels(net_);
+  EXPECT_EQ(0, ConvolutionAutotuner(cache, 1).tune(net_));
+  expectNetworkMatches();
+  remove(cache);
+}
+
+TEST_F(XnorKernelsTest, EveryPlanMatchesDarknet)
+{
+  int xnorLayers = 0;
+  for (int i = 0; i < net_->n; ++i) {
+    const layer& l = net_->layers[i];
+    if (l.type != CONVOLUTIONAL || !l.xnor) continue;
+    ++xnorLayers;
+
+    int plans = 0;
+    for (const ConvolutionPlan& plan : candidatePlans(l)) {
+      if (plan.algorithm != ConvolutionAlgorithm::Xnor) continue;
+      EXPECT_LT(planError(i, plan), Tolerance) << "layer " << i << ", tile " << plan.tile;
+      ++plans;
+    }
+    EXPECT_GT(plans, 0) << "layer " << i;
+  }
+  EXPECT_EQ(3, xnorLayers);
+}
+
+TEST_F(XnorKernelsTest, DefaultKernelsMatchDarknet)
+{
+  EXPECT_EQ(5, installDefaultConvolutionKernels(net_));
+  shrinkWorkspace(net_);
+  expectNetworkMatches();
+}
@@ -0,0 +1,139 @@
+/*
+ * DetectionEvaluation.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+// darknet_ros
+#include "darknet_ros/DetectionEvaluation.hpp"
+
+using darknet_ros::DetectionEvaluation;
+using darknet_ros::EvaluatedBox;
+using darknet_ros::OperatingPoint;
+
+namespace {
+
+/*
+ * Two images, two classes. Detections of class 0 in score order are a hit, a miss, a hit
+ * (overlap 10/11 with its label), a duplicate of the first hit and, at a score of .3, a hit:
+ *   precision 1, 1/2, 2/3, 1/2, 3/5 and recall 1/3, 1/3, 2/3, 2/3, 1.
+ * Class 1 has a hit and then a miss at .4.
+ */
+std::vector<EvaluatedBox> labels()
+{
+  return {{0, 0, 1, 0, 0, .2f, .2f},
+          {0, 0, 1, .5f, .5f, .7f, .7f},
+          {0, 1, 1, .1f, .6f, .3f, .8f},
+          {1, 0, 1, .3f, .3f, .5f, .5f}};
+}
+
+std::vector<EvaluatedBox> detections()
+{
+  return {{0, 0, .9f, 0, 0, .2f, .2f},
+          {1, 0, .8f, .6f, .6f, .8f, .8f},
+          {0, 0, .7f, .5f, .5f, .7f, .72f},
+          {0, 0, .6f, 0, 0, .2f, .2f},
+          {1, 0, .3f, .3f, .3f, .5f, .5f},
+          {0, 1, .5f, .1f, .6f, .3f, .8f},
+          {1, 1, .4f, .1f, .6f, .3f, .8f}};
+}
+
+} /* namespace */
+
+TEST(DetectionEvaluation, AllPointAveragePrecision)
+{
+  const DetectionEvaluation e = darknet_ros::evaluateDetections(labels(), detections(), 2, 2, .25f, .5f);
+  // Interpolated precision 1, 2/3, 2/3, 3/5, 3/5 at the recall steps 1/3, 2/3, 1.
+  EXPECT_NEAR(1. / 3 + 1. / 3 * 2 / 3 + 1. / 3 * 3 / 5, e.classAp[0], 1e-6);
+  EXPECT_NEAR(1, e.classAp[1], 1e-6);
+  EXPECT_NEAR((34. / 45 + 1) / 2, e.map, 1e-6);
+  EXPECT_NEAR(1, e.classRecall[0], 1e-6);
+  EXPECT_NEAR(1, e.classRecall[1], 1e-6);
+  EXPECT_NEAR(4. / 7, e.precision, 1e-6);
+  EXPECT_NEAR(1, e.recall, 1e-6);
+}
+
+TEST(DetectionEvaluation, Threshold)
+{
+  // The class 0 hit at .3 and the class 1 miss at .4 drop out.
+  const DetectionEvaluation e = darknet_ros::evaluateDetections(labels(), detections(), 2, 2, .5f, .5f);
+  EXPECT_NEAR(1. / 3 + 1. / 3 * 2 / 3, e.classAp[0], 1e-6);
+  EXPECT_NEAR(1, e.classAp[1], 1e-6);
+  EXPECT_NEAR(7. / 9, e.map, 1e-6);
+  EXPECT_NEAR(2. / 3, e.classRecall[0], 1e-6);
+  EXPECT_NEAR(3. / 5, e.precision, 1e-6);
+  EXPECT_NEAR(3. / 4, e.recall, 1e-6);
+}
+
+TEST(DetectionEvaluation, Overlap)
+{
+  // The second class 0 hit overlaps its label by 10/11 only and becomes a miss.
+  const DetectionEvaluation e = darknet_ros::evaluateDetections(labels(), detections(), 2, 2, .25f, .95f);
+  EXPECT_NEAR(1. / 3 + 1. / 3 * 2 / 5, e.classAp[0], 1e-6);
+  EXPECT_NEAR(2. / 3, e.classRecall[0], 1e-6);
+}
+
+TEST(DetectionEvaluation, ClassWithoutLabels)
+{
+  // Detections of a class nobody labelled count as misses but do not enter the mAP.
+  std::vector<EvaluatedBox> found = detections();
+  found.push_back({1, 2, .9f, .1f, .1f, .2f, .2f});
+  const DetectionEvaluation e = darknet_ros::evaluateDetections(labels(), found, 2, 3, .25f, .5f);
+  EXPECT_NEAR((34. / 45 + 1) / 2, e.map, 1e-6);
+  EXPECT_EQ(0, e.classAp[2]);
+  EXPECT_NEAR(4. / 8, e.precision, 1e-6);
+}
+
+TEST(DetectionEvaluation, DarknetLabels)
+{
+  char directory[] = "/tmp/darknet_ros_labels_XXXXXX";
+  ASSERT_TRUE(mkdtemp(directory) != nullptr);
+  const std::string file = std::string(directory) + "/frame.txt";
+  {
+    std::ofstream stream(file.c_str());
+    stream << "0 .5 .5 .2 .4\n3 .25 .75 .1 .1\n";
+  }
+  std::vector<EvaluatedBox> objects;
+  darknet_ros::readDarknetLabels("images/frame.jpg", directory, 7, &objects);
+  darknet_ros::readDarknetLabels("images/missing.jpg", directory, 8, &objects);
+  remove(file.c_str());
+  rmdir(directory);
+
+  ASSERT_EQ(2u, objects.size());
+  EXPECT_EQ(7, objects[0].image);
+  EXPECT_EQ(0, objects[0].classId);
+  EXPECT_FLOAT_EQ(.4f, objects[0].xmin);
+  EXPECT_FLOAT_EQ(.3f, objects[0].ymin);
+  EXPECT_FLOAT_EQ(.6f, objects[0].xmax);
+  EXPECT_FLOAT_EQ(.7f, objects[0].ymax);
+  EXPECT_EQ(3, objects[1].classId);
+  EXPECT_FLOAT_EQ(.2f, objects[1].xmin);
+  EXPECT_FLOAT_EQ(.8f, objects[1].ymax);
+}
+
+TEST(DetectionEvaluation, Pareto)
+{
+  std::vector<OperatingPoint> points = {{10, 100, .5, false},    // frontier
+                                        {20, 100, .6, false},    // frontier, most accurate
+                                        {20, 120, .6, false},    // more memory than the one before
+                                        {5, 200, .4, false},     // frontier, fastest
+                                        {10, 100, .5, false},    // tie with the first, kept
+                                        {30, 300, .6, false}};   // beaten by the second
+  darknet_ros::markPareto(&points);
+  const bool expected[] = {true, true, false, true, true, false};
+  for (size_t i = 0; i < points.size(); ++i) {
+    EXPECT_EQ(expected[i], points[i].pareto) << "point " << i;
+  }
+}
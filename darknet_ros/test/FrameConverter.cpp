@@ -0,0 +1,255 @@
+/*
+ * FrameConverter.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <vector>
+
+// darknet_ros
+#include "darknet_ros/FrameConverter.hpp"
+
+using namespace darknet_ros;
+
+namespace {
+
+const int Width = 4;
+const int Height = 2;
+
+//! Colour of pixel (x, y) of the packed test frames.
+void color(int x, int y, unsigned char *rgb)
+{
+  rgb[0] = 30 * x + 100 * y + 1;
+  rgb[1] = 30 * x + 100 * y + 2;
+  rgb[2] = 255 - 30 * x - 100 * y;
+}
+
+CameraFrame makeFrame(const std::vector<unsigned char>& data, PixelFormat format, int step)
+{
+  CameraFrame frame;
+  frame.data = data.data();
+  frame.width = Width;
+  frame.height = Height;
+  frame.step = step;
+  frame.format = format;
+  return frame;
+}
+
+/*
+ * Converts at the size of the frame, where darknet's resampling reads exactly one source
+ * pixel per output pixel, so the output holds what the reader returned for every pixel.
+ */
+class ConvertedFrame
+{
+ public:
+  explicit ConvertedFrame(const CameraFrame& frame)
+      : data_(3 * frame.width * frame.height, -1.f)
+  {
+    out_.w = frame.width;
+    out_.h = frame.height;
+    out_.c = 3;
+    out_.data = data_.data();
+    convertFrame(frame, out_, frame.width, frame.height, 0, 0);
+  }
+
+  float at(int x, int y, int channel) const { return data_[(channel * out_.h + y) * out_.w + x]; }
+
+ private:
+  std::vector<float> data_;
+  image out_;
+};
+
+void expectColor(const ConvertedFrame& frame, int x, int y, float r, float g, float b, float tolerance = 1e-6f)
+{
+  EXPECT_NEAR(r, frame.at(x, y, 0), tolerance) << "red at " << x << ", " << y;
+  EXPECT_NEAR(g, frame.at(x, y, 1), tolerance) << "green at " << x << ", " << y;
+  EXPECT_NEAR(b, frame.at(x, y, 2), tolerance) << "blue at " << x << ", " << y;
+}
+
+} /* namespace */
+
+TEST(FrameConverter, PackedFormats)
+{
+  const struct {
+    PixelFormat format;
+    int channels;
+    int r, g, b;
+  } formats[] = {
+    {PixelFormat::BGR8, 3, 2, 1, 0},
+    {PixelFormat::RGB8, 3, 0, 1, 2},
+    {PixelFormat::BGRA8, 4, 2, 1, 0},
+    {PixelFormat::RGBA8, 4, 0, 1, 2},
+  };
+  for (const auto& entry : formats) {
+    // Rows padded by 3 bytes, so the step is not the packed row size.
+    const int step = Width * entry.channels + 3;
+    std::vector<unsigned char> data(step * Height, 0);
+    for (int y = 0; y < Height; ++y) {
+      for (int x = 0; x < Width; ++x) {
+        unsigned char rgb[3];
+        color(x, y, rgb);
+        unsigned char *pixel = &data[y * step + x * entry.channels];
+        pixel[entry.r] = rgb[0];
+        pixel[entry.g] = rgb[1];
+        pixel[entry.b] = rgb[2];
+      }
+    }
+    const ConvertedFrame converted(makeFrame(data, entry.format, step));
+    for (int y = 0; y < Height; ++y) {
+      for (int x = 0; x < Width; ++x) {
+        unsigned char rgb[3];
+        color(x, y, rgb);
+        expectColor(converted, x, y, rgb[0] / 255.f, rgb[1] / 255.f, rgb[2] / 255.f);
+      }
+    }
+  }
+}
+
+TEST(FrameConverter, Mono)
+{
+  const std::vector<unsigned char> mono8 = {0, 51, 102, 255, 255, 102, 51, 0};
+  const ConvertedFrame converted8(makeFrame(mono8, PixelFormat::MONO8, Width));
+  expectColor(converted8, 1, 0, .2f, .2f, .2f);
+  expectColor(converted8, 3, 0, 1, 1, 1);
+  expectColor(converted8, 1, 1, .4f, .4f, .4f);
+
+  // 0x1234 and 0xffff in both byte orders.
+  std::vector<unsigned char> mono16(2 * Width * Height, 0);
+  mono16[2] = 0x34;
+  mono16[3] = 0x12;
+  mono16[6] = mono16[7] = 0xff;
+  const ConvertedFrame little(makeFrame(mono16, PixelFormat::MONO16, 2 * Width));
+  expectColor(little, 1, 0, 0x1234 / 65535.f, 0x1234 / 65535.f, 0x1234 / 65535.f);
+  expectColor(little, 3, 0, 1, 1, 1);
+  expectColor(little, 0, 1, 0, 0, 0);
+
+  CameraFrame frame = makeFrame(mono16, PixelFormat::MONO16, 2 * Width);
+  frame.bigEndian = true;
+  const ConvertedFrame big(frame);
+  expectColor(big, 1, 0, 0x3412 / 65535.f, 0x3412 / 65535.f, 0x3412 / 65535.f);
+}
+
+/*
+ * BT.601 limited range: Y 16 is black, Y 235 white, and Y 81, U 90, V 240 pure red (R 254.4,
+ * G and B just below 0 and clamped).
+ */
+TEST(FrameConverter, Yuv422)
+{
+  // Pixels 0 and 1 share grey chroma, pixels 2 and 3 red chroma.
+  const unsigned char yuyvRow[] = {16, 128, 235, 128, 81, 90, 81, 240};
+  const unsigned char uyvyRow[] = {128, 16, 128, 235, 90, 81, 240, 81};
+  const struct {
+    PixelFormat format;
+    const unsigned char *row;
+  } formats[] = {{PixelFormat::YUYV, yuyvRow}, {PixelFormat::UYVY, uyvyRow}};
+  for (const auto& entry : formats) {
+    std::vector<unsigned char> data(entry.row, entry.row + 2 * Width);
+    data.insert(data.end(), entry.row, entry.row + 2 * Width);
+    const ConvertedFrame converted(makeFrame(data, entry.format, 2 * Width));
+    for (int y = 0; y < Height; ++y) {
+      expectColor(converted, 0, y, 0, 0, 0, 1e-3f);
+      expectColor(converted, 1, y, 1, 1, 1, 1e-3f);
+      expectColor(converted, 2, y, .9977f, 0, 0, 1e-3f);
+      expectColor(converted, 3, y, .9977f, 0, 0, 1e-3f);
+    }
+  }
+}
+
+TEST(FrameConverter, Yuv420sp)
+{
+  // Left 2x2 block red, right block white; chroma interleaved UV (NV12) or VU (NV21).
+  const unsigned char luma[] = {81, 81, 235, 235, 81, 81, 235, 235};
+  const unsigned char nv12Chroma[] = {90, 240, 128, 128};
+  const unsigned char nv21Chroma[] = {240, 90, 128, 128};
+  const struct {
+    PixelFormat format;
+    const unsigned char *chroma;
+  } formats[] = {{PixelFormat::NV12, nv12Chroma}, {PixelFormat::NV21, nv21Chroma}};
+  for (const auto& entry : formats) {
+    std::vector<unsigned char> data(luma, luma + Width * Height);
+    data.insert(data.end(), entry.chroma, entry.chroma + Width);
+    const ConvertedFrame converted(makeFrame(data, entry.format, Width));
+    for (int y = 0; y < Height; ++y) {
+      expectColor(converted, 0, y, .9977f, 0, 0, 1e-3f);
+      expectColor(converted, 1, y, .9977f, 0, 0, 1e-3f);
+      expectColor(converted, 2, y, 1, 1, 1, 1e-3f);
+      expectColor(converted, 3, y, 1, 1, 1, 1e-3f);
+    }
+  }
+}
+
+TEST(FrameConverter, Bayer)
+{
+  // Two 2x2 cells, values in row-major cell order.
+  const unsigned char cells[2][4] = {{200, 100, 50, 20}, {10, 60, 90, 250}};
+  std::vector<unsigned char> data(Width * Height);
+  for (int cell = 0; cell < 2; ++cell) {
+    for (int k = 0; k < 4; ++k) {
+      data[(k / 2) * Width + 2 * cell + k % 2] = cells[cell][k];
+    }
+  }
+
+  // Positions of red and blue in the cell.
+  const struct {
+    PixelFormat format;
+    int red, blue;
+  } formats[] = {
+    {PixelFormat::BayerRGGB8, 0, 3},
+    {PixelFormat::BayerBGGR8, 3, 0},
+    {PixelFormat::BayerGBRG8, 2, 1},
+    {PixelFormat::BayerGRBG8, 1, 2},
+  };
+  for (const auto& entry : formats) {
+    const ConvertedFrame converted(makeFrame(data, entry.format, Width));
+    for (int cell = 0; cell < 2; ++cell) {
+      const unsigned char *c = cells[cell];
+      const float green = (c[0] + c[1] + c[2] + c[3] - c[entry.red] - c[entry.blue]) / 510.f;
+      for (int k = 0; k < 4; ++k) {
+        expectColor(converted, 2 * cell + k % 2, k / 2, c[entry.red] / 255.f, green, c[entry.blue] / 255.f);
+      }
+    }
+  }
+}
+
+TEST(FrameConverter, Letterbox)
+{
+  // A uniform 4x2 frame fills rows 2 to 5 of an 8x8 input, the rest is grey.
+  std::vector<unsigned char> data(3 * Width * Height);
+  for (size_t i = 0; i < data.size(); i += 3) {
+    data[i] = 51;
+    data[i + 1] = 0;
+    data[i + 2] = 255;
+  }
+  std::vector<float> boxed(3 * 8 * 8, -1.f);
+  image out;
+  out.w = out.h = 8;
+  out.c = 3;
+  out.data = boxed.data();
+  letterboxFrame(makeFrame(data, PixelFormat::BGR8, 3 * Width), out);
+
+  const float inside[3] = {1, 0, .2f};
+  for (int k = 0; k < 3; ++k) {
+    for (int y = 0; y < 8; ++y) {
+      for (int x = 0; x < 8; ++x) {
+        const float expected = (y >= 2 && y < 6) ? inside[k] : .5f;
+        EXPECT_NEAR(expected, boxed[(k * 8 + y) * 8 + x], 1e-6f) << "channel " << k << " at " << x << ", " << y;
+      }
+    }
+  }
+}
+
+TEST(FrameConverter, Encodings)
+{
+  PixelFormat format;
+  ASSERT_TRUE(parsePixelFormat("yuv422", &format));
+  EXPECT_EQ(PixelFormat::UYVY, format);
+  ASSERT_TRUE(parsePixelFormat("16UC1", &format));
+  EXPECT_EQ(PixelFormat::MONO16, format);
+  ASSERT_TRUE(parsePixelFormat("bayer_grbg8", &format));
+  EXPECT_EQ(PixelFormat::BayerGRBG8, format);
+  EXPECT_FALSE(parsePixelFormat("32FC1", &format));
+}
@@ -0,0 +1,164 @@
+/*
+ * NetworkPasses.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <vector>
+
+// darknet_ros
+#include "darknet_ros/Activations.hpp"
+#include "darknet_ros/ConvolutionKernels.hpp"
+#include "darknet_ros/NetworkPasses.hpp"
+#include "RandomNetwork.hpp"
+
+using namespace darknet_ros;
+
+namespace {
+
+const float Tolerance = 1e-4f;
+
+/*
+ * Random network of test/random_network.cfg: a backbone with a shortcut (layer 5), a first
+ * head (7, 8), a single-input route (9) and a route concatenating an upsample with the
+ * shortcut (12) for the second head (14, 15).
+ */
+class NetworkPassesTest : public ::testing::Test
+{
+ protected:
+  void SetUp() override
+  {
+    net_ = loadRandomNetwork("random_network.cfg");
+    input_ = randomInput(net_);
+  }
+
+  void TearDown() override
+  {
+    clearConvolutionKernels(net_);
+    // Fused networks share buffers between layers, darknet can not free them.
+    if (!fused_) free_network(net_);
+  }
+
+  //! Outputs of the detection layers.
+  std::vector<std::vector<float> > headOutputs()
+  {
+    const std::vector<std::vector<float> > outputs = layerOutputs(net_, input_);
+    std::vector<std::vector<float> > heads;
+    for (int i = 0; i < net_->n; ++i) {
+      if (isDetectionLayer(net_->layers[i])) heads.push_back(outputs[i]);
+    }
+    return heads;
+  }
+
+  void expectHeadsMatch(const std::vector<std::vector<float> >& reference)
+  {
+    const std::vector<std::vector<float> > heads = headOutputs();
+    ASSERT_EQ(reference.size(), heads.size());
+    for (size_t i = 0; i < heads.size(); ++i) {
+      EXPECT_LT(maxError(heads[i], reference[i]), Tolerance) << "head " << i;
+    }
+  }
+
+  //! Makes a filter of a convolution output constant zero.
+  void zeroFilter(int index, int filter)
+  {
+    layer& l = net_->layers[index];
+    const int size = l.c * l.size * l.size;
+    std::fill(l.weights + filter * size, l.weights + (filter + 1) * size, 0.f);
+    l.biases[filter] = 0;
+    if (l.batch_normalize) l.rolling_mean[filter] = 0;
+  }
+
+  network *net_;
+  std::vector<float> input_;
+  bool fused_ = false;
+};
+
+} /* namespace */
+
+TEST_F(NetworkPassesTest, FusedRoutesMatchCopies)
+{
+  const std::vector<std::vector<float> > reference = headOutputs();
+
+  EXPECT_EQ(2, fuseRouteConcatenations(net_));
+  fused_ = true;
+  const layer* layers = net_->layers;
+  EXPECT_EQ(layers[12].output, layers[11].output);
+  EXPECT_EQ(layers[12].output + layers[11].outputs, layers[5].output);
+  EXPECT_EQ(layers[9].output, layers[6].output);
+  expectHeadsMatch(reference);
+
+  // Installed kernels write into the views as well.
+  installDefaultConvolutionKernels(net_);
+  installVectorizedActivations(net_);
+  expectHeadsMatch(reference);
+}
+
+TEST_F(NetworkPassesTest, PrunedChannelsMatchFullNetwork)
+{
+  // Two filters of layer 3, and the same two filters of both inputs of the shortcut.
+  zeroFilter(3, 1);
+  zeroFilter(3, 5);
+  for (int index : {2, 4}) {
+    zeroFilter(index, 2);
+    zeroFilter(index, 7);
+  }
+  const std::vector<std::vector<float> > reference = headOutputs();
+
+  EXPECT_EQ(6, pruneZeroChannels(net_));
+  EXPECT_EQ(6, net_->layers[3].out_c);
+  EXPECT_EQ(6, net_->layers[4].c);
+  EXPECT_EQ(14, net_->layers[5].out_c);
+  EXPECT_EQ(14, net_->layers[6].c);
+  EXPECT_EQ(8 + 14, net_->layers[12].out_c);
+  EXPECT_EQ(8 + 14, net_->layers[13].c);
+  expectHeadsMatch(reference);
+
+  installDefaultConvolutionKernels(net_);
+  installVectorizedActivations(net_);
+  expectHeadsMatch(reference);
+}
+
+TEST_F(NetworkPassesTest, LogisticShortcutKeepsChannels)
+{
+  // logistic(0) is not 0, the channels zero in both shortcut inputs are not zero after it.
+  net_->layers[5].activation = LOGISTIC;
+  zeroFilter(3, 1);
+  for (int index : {2, 4}) {
+    zeroFilter(index, 2);
+  }
+  const std::vector<std::vector<float> > reference = headOutputs();
+
+  EXPECT_EQ(1, pruneZeroChannels(net_));
+  EXPECT_EQ(7, net_->layers[3].out_c);
+  EXPECT_EQ(16, net_->layers[2].out_c);
+  EXPECT_EQ(16, net_->layers[4].out_c);
+  EXPECT_EQ(16, net_->layers[5].out_c);
+  expectHeadsMatch(reference);
+}
+
+TEST_F(NetworkPassesTest, KeptHeadsMatchFullNetwork)
+{
+  const std::vector<std::vector<float> > reference = headOutputs();
+  EXPECT_EQ(-1, pruneDetectionHeads(net_, {2}));
+  EXPECT_EQ(16, net_->n);
+
+  // The second head needs everything but the first head's convolution and yolo layer.
+  EXPECT_EQ(2, pruneDetectionHeads(net_, {1}));
+  EXPECT_EQ(14, net_->n);
+  std::vector<std::vector<float> > heads = headOutputs();
+  ASSERT_EQ(1u, heads.size());
+  EXPECT_LT(maxError(heads[0], reference[1]), Tolerance);
+
+  free_network(net_);
+  net_ = loadRandomNetwork("random_network.cfg");
+  EXPECT_EQ(7, pruneDetectionHeads(net_, {0}));
+  EXPECT_EQ(9, net_->n);
+  heads = headOutputs();
+  ASSERT_EQ(1u, heads.size());
+  EXPECT_LT(maxError(heads[0], reference[0]), Tolerance);
+}
@@ -0,0 +1,99 @@
+/*
+ * RandomNetwork.hpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+#pragma once
+
+// c++
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "network.h"
+#include "parser.h"
+}
+
+#ifndef TEST_NETWORK_PATH
+#error Path of the test networks is not defined in CMakeLists.txt.
+#endif
+
+namespace darknet_ros {
+
+/*!
+ * Parses a cfg of the test directory for batch size 1 and fills the weights, biases and batch
+ * norm statistics of its convolutions with random values, the same for the same seed.
+ */
+inline network *loadRandomNetwork(const std::string& cfg, unsigned seed = 1)
+{
+  std::string path = std::string(TEST_NETWORK_PATH) + "/" + cfg;
+  network *net = parse_network_cfg(&path[0]);
+  set_batch_network(net, 1);
+
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<float> uniform(-1.f, 1.f);
+  for (int i = 0; i < net->n; ++i) {
+    layer& l = net->layers[i];
+    if (l.type != CONVOLUTIONAL) continue;
+    // Keeps the outputs of every layer around the magnitude of its inputs.
+    const float range = std::sqrt(3.f / (l.c * l.size * l.size));
+    for (int k = 0; k < l.nweights; ++k) {
+      l.weights[k] = range * uniform(generator);
+    }
+    for (int k = 0; k < l.n; ++k) {
+      l.biases[k] = .1f * uniform(generator);
+      if (!l.batch_normalize) continue;
+      l.scales[k] = 1 + .25f * uniform(generator);
+      l.rolling_mean[k] = .1f * uniform(generator);
+      l.rolling_variance[k] = 1 + .25f * uniform(generator);
+    }
+  }
+  return net;
+}
+
+//! Random network input in [0, 1].
+inline std::vector<float> randomInput(const network *net, unsigned seed = 2)
+{
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<float> uniform(0.f, 1.f);
+  std::vector<float> input(net->inputs * net->batch);
+  for (float& value : input) {
+    value = uniform(generator);
+  }
+  return input;
+}
+
+//! Runs the network on a copy of the input and copies the output of every layer.
+inline std::vector<std::vector<float> > layerOutputs(network *net, std::vector<float> input)
+{
+  network_predict(net, input.data());
+  std::vector<std::vector<float> > outputs(net->n);
+  for (int i = 0; i < net->n; ++i) {
+    const layer& l = net->layers[i];
+    outputs[i].assign(l.output, l.output + l.outputs * l.batch);
+  }
+  return outputs;
+}
+
+//! Largest difference to the expected values, relative to their magnitude where above 1.
+inline float maxError(const float *actual, const std::vector<float>& expected)
+{
+  float error = 0;
+  for (size_t i = 0; i < expected.size(); ++i) {
+    if (std::isnan(actual[i])) return INFINITY;
+    error = std::max(error, std::fabs(actual[i] - expected[i]) / std::max(1.f, std::fabs(expected[i])));
+  }
+  return error;
+}
+
+inline float maxError(const std::vector<float>& actual, const std::vector<float>& expected)
+{
+  if (actual.size() != expected.size()) return INFINITY;
+  return maxError(actual.data(), expected);
+}
+
+} /* namespace darknet_ros*/
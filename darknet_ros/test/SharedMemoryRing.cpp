@@ -0,0 +1,179 @@
+/*
+ * SharedMemoryRing.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// darknet_ros
+#include "darknet_ros/SharedMemoryRing.hpp"
+
+using namespace darknet_ros;
+
+namespace {
+
+const char RingName[] = "/darknet_ros_test_ring";
+const uint32_t SlotCount = 3;
+const size_t Values = 64;
+
+//! Writes a payload of count copies of value, stamped with the value.
+void writeValues(SharedMemoryRing& ring, uint32_t value, uint32_t *slot = nullptr, size_t count = Values)
+{
+  uint32_t written;
+  uint32_t *payload = static_cast<uint32_t *>(ring.beginWrite(&written));
+  std::fill(payload, payload + count, value);
+  ring.commit(value, count * sizeof(uint32_t));
+  if (slot) *slot = written;
+}
+
+} /* namespace */
+
+TEST(SharedMemoryRing, RoundTrip)
+{
+  SharedMemoryRing ring(RingName, HeadTensorsMagic, SlotCount, Values * sizeof(uint32_t));
+  ASSERT_TRUE(ring.valid());
+  SharedMemoryRingReader reader;
+  ASSERT_TRUE(reader.open(RingName, HeadTensorsMagic));
+  EXPECT_EQ(SlotCount, reader.header()->slotCount);
+
+  std::vector<uint32_t> buffer(Values);
+  uint64_t stamp = 0;
+  EXPECT_EQ(0u, reader.readLatest(buffer.data(), buffer.size() * sizeof(uint32_t), &stamp));
+
+  writeValues(ring, 7);
+  ASSERT_EQ(Values * sizeof(uint32_t), reader.readLatest(buffer.data(), buffer.size() * sizeof(uint32_t), &stamp));
+  EXPECT_EQ(7u, stamp);
+  EXPECT_EQ(std::vector<uint32_t>(Values, 7), buffer);
+
+  // A smaller buffer gets the start of the payload.
+  uint32_t first[2] = {0, 0};
+  EXPECT_EQ(sizeof(first), reader.readLatest(first, sizeof(first)));
+  EXPECT_EQ(7u, first[1]);
+}
+
+TEST(SharedMemoryRing, OpenChecksFormat)
+{
+  SharedMemoryRingReader reader;
+  EXPECT_FALSE(reader.open(RingName, HeadTensorsMagic));
+
+  SharedMemoryRing ring(RingName, HeadTensorsMagic, SlotCount, 16);
+  ASSERT_TRUE(ring.valid());
+  EXPECT_FALSE(reader.open(RingName, DetectionsMagic));
+  EXPECT_EQ(nullptr, reader.header());
+  EXPECT_TRUE(reader.open(RingName, HeadTensorsMagic));
+}
+
+TEST(SharedMemoryRing, SlotsInPlace)
+{
+  SharedMemoryRing ring(RingName, HeadTensorsMagic, SlotCount, Values * sizeof(uint32_t));
+  ASSERT_TRUE(ring.valid());
+  SharedMemoryRingReader reader;
+  ASSERT_TRUE(reader.open(RingName, HeadTensorsMagic));
+
+  uint32_t slot;
+  uint32_t *payload = static_cast<uint32_t *>(ring.beginWrite(&slot));
+  EXPECT_EQ(0u, slot);
+  EXPECT_EQ(1u, reader.sequence(slot) & 1) << "odd while written";
+  EXPECT_FALSE(reader.unchanged(slot, reader.sequence(slot)));
+  payload[0] = 42;
+  const uint64_t sequence = ring.commit(5, sizeof(uint32_t));
+  EXPECT_EQ(0u, sequence & 1);
+  EXPECT_EQ(sequence, reader.sequence(slot));
+
+  // Readers find the payload at the offset the writer hands out.
+  const char *segment = reinterpret_cast<const char *>(reader.header());
+  EXPECT_EQ(segment + ring.payloadOffset(slot), reader.payload(slot));
+  EXPECT_EQ(42u, *static_cast<const uint32_t *>(reader.payload(slot)));
+  EXPECT_TRUE(reader.unchanged(slot, sequence));
+
+  // Overwriting the slot invalidates what was read at the old sequence.
+  for (uint32_t value = 0; value < SlotCount; ++value) {
+    writeValues(ring, value);
+  }
+  EXPECT_FALSE(reader.unchanged(slot, sequence));
+}
+
+TEST(SharedMemoryRing, Wraps)
+{
+  SharedMemoryRing ring(RingName, HeadTensorsMagic, SlotCount, Values * sizeof(uint32_t));
+  ASSERT_TRUE(ring.valid());
+  SharedMemoryRingReader reader;
+  ASSERT_TRUE(reader.open(RingName, HeadTensorsMagic));
+
+  std::vector<uint32_t> buffer(Values);
+  for (uint32_t value = 0; value < 3 * SlotCount + 1; ++value) {
+    uint32_t slot;
+    writeValues(ring, value, &slot);
+    EXPECT_EQ(value % SlotCount, slot);
+    uint64_t stamp;
+    ASSERT_GT(reader.readLatest(buffer.data(), buffer.size() * sizeof(uint32_t), &stamp), 0u);
+    EXPECT_EQ(value, stamp);
+    EXPECT_EQ(std::vector<uint32_t>(Values, value), buffer);
+  }
+  EXPECT_EQ(3 * SlotCount + 1, reader.header()->written.load());
+}
+
+TEST(SharedMemoryRing, SkipsSlotBeingWritten)
+{
+  SharedMemoryRing ring(RingName, HeadTensorsMagic, 1, Values * sizeof(uint32_t));
+  ASSERT_TRUE(ring.valid());
+  SharedMemoryRingReader reader;
+  ASSERT_TRUE(reader.open(RingName, HeadTensorsMagic));
+  writeValues(ring, 1);
+
+  // The only slot is open for the next payload, there is nothing complete to copy.
+  uint32_t slot;
+  ring.beginWrite(&slot);
+  std::vector<uint32_t> buffer(Values);
+  EXPECT_EQ(0u, reader.readLatest(buffer.data(), buffer.size() * sizeof(uint32_t)));
+  ring.commit(2, Values * sizeof(uint32_t));
+  uint64_t stamp;
+  EXPECT_GT(reader.readLatest(buffer.data(), buffer.size() * sizeof(uint32_t), &stamp), 0u);
+  EXPECT_EQ(2u, stamp);
+}
+
+TEST(SharedMemoryRing, NoTornReads)
+{
+  // A single large slot, so the writer overwrites the payload readers copy all the time.
+  const size_t count = 16384;
+  SharedMemoryRing ring(RingName, HeadTensorsMagic, 1, count * sizeof(uint32_t));
+  ASSERT_TRUE(ring.valid());
+  SharedMemoryRingReader reader;
+  ASSERT_TRUE(reader.open(RingName, HeadTensorsMagic));
+
+  const uint32_t payloads = 5000;
+  std::atomic<bool> done(false);
+  std::thread writer([&]() {
+    for (uint32_t value = 1; value <= payloads; ++value) {
+      writeValues(ring, value, nullptr, count);
+    }
+    done = true;
+  });
+
+  // Every accepted copy holds a single payload, stamped with its own value.
+  std::vector<uint32_t> buffer(count);
+  int reads = 0;
+  uint64_t last = 0;
+  while (!done || last < payloads) {
+    uint64_t stamp;
+    if (reader.readLatest(buffer.data(), buffer.size() * sizeof(uint32_t), &stamp) == 0) continue;
+    if (buffer != std::vector<uint32_t>(count, (uint32_t) stamp)) {
+      ADD_FAILURE() << "torn read of payload " << stamp;
+      break;
+    }
+    EXPECT_GE(stamp, last);
+    last = stamp;
+    ++reads;
+  }
+  writer.join();
+  EXPECT_GT(reads, 0);
+  EXPECT_EQ(payloads, last);
+}
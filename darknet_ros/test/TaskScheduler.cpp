@@ -0,0 +1,68 @@
+/*
+ * TaskScheduler.cpp
+ *
+ *  Created on: Oct 18, 2026
+ */
+
+// Google Test
+#include <gtest/gtest.h>
+
+// c++
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// darknet_ros
+#include "darknet_ros/TaskScheduler.hpp"
+
+using namespace darknet_ros;
+
+TEST(TaskScheduler, SingleCoreRunsOnCallingThread)
+{
+  TaskScheduler scheduler(1);
+  EXPECT_EQ(1, scheduler.concurrency());
+
+  const std::thread::id caller = std::this_thread::get_id();
+  std::vector<int> order;
+  scheduler.submit([&] {
+    EXPECT_EQ(caller, std::this_thread::get_id());
+    // Runs after this task instead of inside it.
+    scheduler.submit([&] { order.push_back(2); });
+    order.push_back(1);
+  });
+  EXPECT_EQ(std::vector<int>({1, 2}), order);
+
+  // Groups nested in a task are run by their waiter.
+  std::atomic<int> done(0);
+  TaskGroup outer(scheduler, TaskPriority::Critical);
+  outer.run([&] {
+    TaskGroup inner(scheduler, TaskPriority::Critical);
+    for (int i = 0; i < 4; ++i) {
+      inner.run([&] {
+        EXPECT_EQ(caller, std::this_thread::get_id());
+        ++done;
+      });
+    }
+    inner.wait();
+    EXPECT_EQ(4, done.load());
+  });
+  outer.wait();
+  EXPECT_EQ(4, done.load());
+}
+
+TEST(TaskScheduler, ParallelForCoversRange)
+{
+  for (int threads : {1, 3}) {
+    TaskScheduler scheduler(threads);
+    EXPECT_EQ(threads, scheduler.concurrency());
+    std::vector<std::atomic<int> > visits(1000);
+    scheduler.parallelFor(0, (int) visits.size(), 7, [&](int first, int last) {
+      for (int i = first; i < last; ++i) {
+        ++visits[i];
+      }
+    });
+    for (size_t i = 0; i < visits.size(); ++i) {
+      EXPECT_EQ(1, visits[i].load()) << "index " << i << ", " << threads << " threads";
+    }
+  }
+}